@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <sys/mman.h>
+
+using std::align_val_t;
+using std::bad_alloc;
+using std::is_trivially_destructible_v;
+using std::max;
+using std::min;
+using std::vector;
+
+size_t const arenaMinBlock_ {size_t {1} << 10};
+size_t const arenaMapBlock_ {size_t {1} << 20};
+size_t const arenaMaxBlock_ {size_t {1} << 26};
+size_t const hugePage_ {size_t {1} << 21};
+
+/*! Allocator for objects that are only released all at once.
+ *
+ * Objects are placed one after the other in blocks. Every block is as large
+ * as all previous blocks together, up to 64 MiB. Blocks of less than 1 MiB
+ * come from the heap, so many small arenas neither waste memory nor run out
+ * of memory mappings. Larger blocks are mapped directly from the operating
+ * system, using huge pages where available. Releasing the objects frees the
+ * blocks, the objects themselves are only visited if they have a
+ * non-trivial destructor.
+ */
+template <class T>
+class Arena {
+public:
+  Arena() = default;
+  Arena(Arena const&) = delete;
+  ~Arena();
+
+  Arena& operator=(Arena const&) = delete;
+
+  /*! Make a value initialised object.
+   *
+   * \return New object.
+   */
+  T* make();
+
+  /*! Get the number of objects.
+   *
+   * \return Number of objects.
+   */
+  size_t size() const;
+
+  /*! Get the number of bytes of all blocks.
+   *
+   * \return Number of bytes.
+   */
+  size_t bytes() const;
+
+private:
+  struct Block_ {
+    T* data;
+    size_t used;
+    size_t capacity;
+    bool mapped;
+  };
+
+  void grow_();
+
+  vector<Block_> blocks_ {};
+  size_t size_ {0};
+  size_t bytes_ {0};
+};
+
+
+template <class T>
+Arena<T>::~Arena() {
+  for (Block_ const& block: blocks_) {
+    if constexpr (not is_trivially_destructible_v<T>) {
+      for (size_t i {0}; i < block.used; i++) {
+        block.data[i].~T();
+      }
+    }
+    if (block.mapped) {
+      munmap(block.data, block.capacity * sizeof(T));
+    }
+    else {
+      ::operator delete(block.data, align_val_t {alignof(T)});
+    }
+  }
+}
+
+/* Allocate a new block. */
+template <class T>
+void Arena<T>::grow_() {
+  size_t const bytes {min(
+    max({bytes_, arenaMinBlock_, sizeof(T)}), arenaMaxBlock_)};
+  if (bytes < arenaMapBlock_) {
+    void* const data {::operator new(bytes, align_val_t {alignof(T)})};
+    blocks_.push_back({static_cast<T*>(data), 0, bytes / sizeof(T), false});
+    bytes_ += bytes;
+    return;
+  }
+
+  void* const data {mmap(
+    nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+    0)};
+  if (data == MAP_FAILED) {
+    throw bad_alloc();
+  }
+#ifdef MADV_HUGEPAGE
+  if (bytes >= hugePage_) {
+    madvise(data, bytes, MADV_HUGEPAGE);
+  }
+#endif
+
+  blocks_.push_back({static_cast<T*>(data), 0, bytes / sizeof(T), true});
+  bytes_ += bytes;
+}
+
+template <class T>
+T* Arena<T>::make() {
+  if (blocks_.empty() or blocks_.back().used == blocks_.back().capacity) {
+    grow_();
+  }
+  size_++;
+  return new (blocks_.back().data + blocks_.back().used++) T {};
+}
+
+template <class T>
+size_t Arena<T>::size() const {
+  return size_;
+}
+
+template <class T>
+size_t Arena<T>::bytes() const {
+  return bytes_;
+}
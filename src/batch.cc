@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "batch.h"
+
+using std::condition_variable;
+using std::exception;
+using std::filesystem::file_size;
+using std::getline;
+using std::ifstream;
+using std::invalid_argument;
+using std::istringstream;
+using std::min;
+using std::mutex;
+using std::numeric_limits;
+using std::stable_sort;
+using std::thread;
+using std::unique_lock;
+
+
+vector<Sample> readManifest(string const fileName) {
+  ifstream manifest {fileName};
+  if (not manifest) {
+    throw invalid_argument("cannot open manifest " + fileName);
+  }
+
+  vector<Sample> samples;
+  string line;
+  for (size_t lineNumber {1}; getline(manifest, line); lineNumber++) {
+    if (not line.empty() and line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty() or line[0] == '#') {
+      continue;
+    }
+
+    vector<string> fields;
+    istringstream stream {line};
+    for (string field; getline(stream, field, '\t');) {
+      if (not field.empty()) {
+        fields.push_back(field);
+      }
+    }
+    if (fields.size() < 3) {
+      throw invalid_argument(
+        "line " + std::to_string(lineNumber) +
+        " of the manifest needs a name, a directory and input files");
+    }
+
+    Sample sample {fields[0], fields[1], {fields.begin() + 2, fields.end()}};
+    for (string const& file: sample.files) {
+      sample.size += file_size(file);
+    }
+    samples.push_back(sample);
+  }
+
+  stable_sort(
+    samples.begin(), samples.end(),
+    [](Sample const& a, Sample const& b) { return a.size > b.size; });
+
+  return samples;
+}
+
+size_t nextSample(
+    vector<Sample> const& samples, vector<bool> const& started,
+    size_t const available, bool const idle) {
+  for (size_t i {0}; i < samples.size(); i++) {
+    if (not started[i] and (idle or samples[i].size <= available)) {
+      return i;
+    }
+  }
+  return samples.size();
+}
+
+size_t runBatch(
+    vector<Sample> const& samples, size_t const workers,
+    size_t const budget, function<void(Sample const&)> const& run,
+    ofstream& log) {
+  mutex lock;
+  condition_variable changed;
+  vector<bool> started(samples.size(), false);
+  size_t remaining {samples.size()};
+  size_t available {budget ? budget : numeric_limits<size_t>::max()};
+  size_t running {0};
+  size_t failed {0};
+
+  auto worker {[&]() {
+    unique_lock<mutex> guard {lock};
+    while (remaining) {
+      size_t i {nextSample(samples, started, available, not running)};
+      if (i == samples.size()) {
+        changed.wait(guard);
+        continue;
+      }
+
+      Sample const& sample {samples[i]};
+      size_t const reserved {min(sample.size, available)};
+      started[i] = true;
+      remaining--;
+      available -= reserved;
+      running++;
+      log << "Started " << sample.name << ".\n" << std::flush;
+      guard.unlock();
+
+      string error;
+      try {
+        run(sample);
+      }
+      catch (exception const& e) {
+        error = e.what();
+      }
+
+      guard.lock();
+      available += reserved;
+      running--;
+      if (error.empty()) {
+        log << "Finished " << sample.name << ".\n" << std::flush;
+      }
+      else {
+        failed++;
+        log << "Failed " << sample.name << ": " << error << "\n" << std::flush;
+      }
+      changed.notify_all();
+    }
+  }};
+
+  vector<thread> pool;
+  for (size_t i {1}; i < min(workers, samples.size()); i++) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (thread& t: pool) {
+    t.join();
+  }
+
+  return failed;
+}
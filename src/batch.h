@@ -0,0 +1,58 @@
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+using std::function;
+using std::ofstream;
+using std::string;
+using std::vector;
+
+/*! Sample in a batch. */
+struct Sample {
+  string name {};
+  string dirName {};
+  vector<string> files {};
+  size_t size {0};   //!< Total size of the input files.
+};
+
+
+/*! Read a manifest. Every line contains a sample name, an output directory
+ * and one or more FastQ files, separated by tabs. Empty lines and lines
+ * starting with `#` are ignored.
+ *
+ * \param fileName Manifest file name.
+ *
+ * \return Samples, largest first.
+ */
+vector<Sample> readManifest(string const);
+
+/*! Select the next sample to run.
+ *
+ * \param samples Samples, largest first.
+ * \param started Samples that have been started.
+ * \param available Input size that is still available.
+ * \param idle No other samples are running.
+ *
+ * \return Index of the largest sample that fits in the available size (or
+ *   the largest sample if `idle` is set), `samples.size()` if there is none.
+ */
+size_t nextSample(
+  vector<Sample> const&, vector<bool> const&, size_t const, bool const);
+
+/*! Run a batch of samples.
+ *
+ * \param samples Samples, largest first.
+ * \param workers Number of samples that are run in parallel.
+ * \param budget Budget for the total input size of the running samples, 0
+ *   for no limit.
+ * \param run Function that processes one sample.
+ * \param log Log file.
+ *
+ * \return Number of failed samples.
+ */
+size_t runBatch(
+  vector<Sample> const&, size_t const, size_t const,
+  function<void(Sample const&)> const&, ofstream&);
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include <isa-l/igzip_lib.h>
+
+#include "bgzf.h"
+
+using std::filesystem::is_regular_file;
+using std::ifstream;
+using std::lock_guard;
+using std::max;
+using std::runtime_error;
+using std::to_string;
+using std::unique_lock;
+
+size_t const headerSize_ {18};
+size_t const blocksPerThread_ {256};
+
+// Empty block that ends every BGZF file.
+constexpr string_view eofBlock_ {
+  "\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff\x06\x00\x42\x43\x02\x00"
+  "\x1b\x00\x03\x00\x00\x00\x00\x00\x00\x00\x00\x00", 28};
+
+
+/* Read a little endian integer.
+ *
+ * \param data Buffer.
+ * \param size Size of the integer in bytes.
+ *
+ * \return Integer.
+ */
+size_t littleEndian_(char const* data, size_t const size) {
+  size_t result {0};
+  for (size_t i {size}; i > 0; i--) {
+    result = (result << 8) | static_cast<uint8_t>(data[i - 1]);
+  }
+  return result;
+}
+
+/* Inflate one BGZF block.
+ *
+ * \param block BGZF block.
+ * \param output Output buffer.
+ * \param size Size of the inflated block.
+ *
+ * \return `true` on success.
+ */
+bool inflateBlock_(string_view const block, char* output, size_t const size) {
+  if (not size) {
+    return true;
+  }
+
+  inflate_state state;
+  isal_inflate_init(&state);
+  state.crc_flag = ISAL_GZIP;
+  state.next_in = (uint8_t*)block.data();
+  state.avail_in = block.size();
+  state.next_out = (uint8_t*)output;
+  state.avail_out = size;
+
+  return
+    isal_inflate(&state) == ISAL_DECOMP_OK and
+    state.block_state == ISAL_BLOCK_FINISH and not state.avail_out;
+}
+
+
+BlockFastq::BlockFastq(char const filename[], size_t const threads)
+    : filename_ {filename}, file_(filename),
+      threads_ {max(threads, size_t {1})} {
+  buffers_.emplace_back();
+  start_();
+  for (size_t i {0}; i < threads_; i++) {
+    workers_.emplace_back(&BlockFastq::work_, this);
+  }
+}
+
+BlockFastq::~BlockFastq() {
+  {
+    lock_guard<mutex> guard {lock_};
+    stop_ = true;
+  }
+  ready_.notify_all();
+  for (thread& worker: workers_) {
+    worker.join();
+  }
+}
+
+/* Split the next part of the file into blocks, and hand them to the
+ * workers.
+ */
+void BlockFastq::start_() {
+  vector<string_view> blocks;
+  vector<size_t> offsets {0};
+  while (pos_ < file_.size and blocks.size() < threads_ * blocksPerThread_) {
+    string_view data(file_.data + pos_, file_.size - pos_);
+    size_t size {blockSize(data)};
+    if (not size or size > data.size()) {
+      throw runtime_error(
+        filename_ + ": invalid BGZF block at byte " + to_string(pos_) +
+        ", only files that are BGZF compressed throughout are supported");
+    }
+    blocks.push_back(data.substr(0, size));
+    offsets.push_back(
+      offsets.back() + littleEndian_(file_.data + pos_ + size - 4, 4));
+    pos_ += size;
+  }
+
+  {
+    lock_guard<mutex> guard {lock_};
+    blocks_.swap(blocks);
+    offsets_.swap(offsets);
+    output_.assign(offsets_.back(), '\0');
+    next_ = 0;
+    finished_ = 0;
+    corrupt_ = false;
+  }
+  ready_.notify_all();
+}
+
+/* Wait for the workers to inflate the current batch.
+ *
+ * \return Inflated batch.
+ */
+string BlockFastq::finish_() {
+  unique_lock<mutex> guard {lock_};
+  done_.wait(guard, [this]() { return finished_ == blocks_.size(); });
+  if (corrupt_) {
+    throw runtime_error(filename_ + ": corrupt BGZF block");
+  }
+  guard.unlock();
+
+  file_.release(pos_);
+
+  return std::move(output_);
+}
+
+/* Inflate blocks of the current batch, each directly into its place in the
+ * output, until the reader is destroyed.
+ */
+void BlockFastq::work_() {
+  unique_lock<mutex> guard {lock_};
+  while (true) {
+    ready_.wait(guard, [this]() {
+      return stop_ or next_ < blocks_.size();
+    });
+    if (stop_) {
+      return;
+    }
+
+    size_t const i {next_++};
+    guard.unlock();
+    bool const success {inflateBlock_(
+      blocks_[i], output_.data() + offsets_[i], offsets_[i + 1] - offsets_[i])};
+    guard.lock();
+
+    corrupt_ = corrupt_ or not success;
+    if (++finished_ == blocks_.size()) {
+      done_.notify_all();
+    }
+  }
+}
+
+bool BlockFastq::read(Record& record) {
+  while (true) {
+    size_t consumed {parseRecord(
+      string_view(buffers_.back()).substr(offset_), record, eof_)};
+    if (consumed) {
+      offset_ += consumed;
+      return true;
+    }
+    if (eof_) {
+      return false;
+    }
+
+    // Start a new buffer with the incomplete record and the next batch. The
+    // earlier buffers stay in place, for the records that refer to them.
+    string buffer {string_view(buffers_.back()).substr(offset_)};
+    buffer += finish_();
+    buffers_.push_back(std::move(buffer));
+    offset_ = 0;
+    if (pos_ < file_.size) {
+      start_();
+    }
+    else {
+      eof_ = true;
+    }
+  }
+}
+
+void BlockFastq::release() {
+  while (buffers_.size() > 1) {
+    buffers_.pop_front();
+  }
+}
+
+
+size_t blockSize(string_view const data) {
+  // Magic, compression method and FEXTRA flag.
+  if (
+      data.size() < headerSize_ or data[0] != '\x1f' or data[1] != '\x8b' or
+      data[2] != 8 or not (data[3] & 4)) {
+    return 0;
+  }
+
+  // Look for the BC subfield, which holds the block size minus one.
+  size_t xlen {littleEndian_(data.data() + 10, 2)};
+  size_t pos {12};
+  while (pos + 4 <= 12 + xlen and pos + 4 <= data.size()) {
+    size_t slen {littleEndian_(data.data() + pos + 2, 2)};
+    if (
+        data[pos] == 'B' and data[pos + 1] == 'C' and slen == 2 and
+        pos + 6 <= data.size()) {
+      return littleEndian_(data.data() + pos + 4, 2) + 1;
+    }
+    pos += 4 + slen;
+  }
+  return 0;
+}
+
+bool blockCompressed(string const filename) {
+  if (not is_regular_file(filename)) {
+    return false;
+  }
+
+  char header[headerSize_] {};
+  ifstream input(filename, std::ios::binary);
+  input.read(header, headerSize_);
+  if (not blockSize(string_view(header, input.gcount()))) {
+    return false;
+  }
+
+  char tail[eofBlock_.size()] {};
+  input.seekg(-static_cast<long>(eofBlock_.size()), std::ios::end);
+  input.read(tail, eofBlock_.size());
+
+  return string_view(tail, input.gcount()) == eofBlock_;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "mapped.h"
+
+using std::condition_variable;
+using std::deque;
+using std::mutex;
+using std::thread;
+
+/*! Reader for BGZF compressed FastQ files.
+ *
+ * BGZF files consist of independent gzip members that record their own
+ * compressed size. This allows batches of members to be inflated in parallel
+ * by a fixed set of workers, while the previous batch is being parsed.
+ * Inflated batches are kept until `release()` is called.
+ */
+class BlockFastq : public RecordReader {
+public:
+  BlockFastq(char const[], size_t const);
+  BlockFastq(BlockFastq const&) = delete;
+  ~BlockFastq();
+
+  BlockFastq& operator=(BlockFastq const&) = delete;
+
+  bool read(Record&);
+  void release();
+
+private:
+  void start_();
+  string finish_();
+  void work_();
+
+  string filename_;
+  MappedFile file_;
+  size_t threads_;
+  size_t pos_ {0};
+  deque<string> buffers_ {};  // Records are read from the last one.
+  size_t offset_ {0};
+  bool eof_ {false};
+
+  // Batch that is being inflated by the workers.
+  vector<string_view> blocks_ {};
+  vector<size_t> offsets_ {};
+  string output_ {};
+  size_t next_ {0};
+  size_t finished_ {0};
+  bool corrupt_ {false};
+  bool stop_ {false};
+  mutex lock_ {};
+  condition_variable ready_ {};
+  condition_variable done_ {};
+  vector<thread> workers_ {};
+};
+
+
+/*! Determine the size of a BGZF block.
+ *
+ * \param data Buffer starting at the block.
+ *
+ * \return Size of the block, 0 if `data` does not start with a BGZF block.
+ */
+size_t blockSize(string_view const);
+
+/*! Determine whether a file is BGZF compressed. Only the first block and
+ * the end-of-file block are checked, so a gzip file with other members
+ * appended to a BGZF file is read as an ordinary gzip file.
+ *
+ * \param filename File name.
+ *
+ * \return `true` if the file starts with a BGZF block and ends with a BGZF
+ *   end-of-file block.
+ */
+bool blockCompressed(string const);
@@ -86,6 +86,14 @@ void assignDirectionalCluster(NLeaf* leaf, Cluster* cluster) {
   assignDirectionalCluster_(node, cluster);
 }
 
+bool canDominate(NLeaf const* const leaf) {
+  return atLeastDouble_(leaf->count, 1);
+}
+
+bool dominates(NLeaf const* const leaf, NLeaf const* const neighbour) {
+  return atLeastDouble_(leaf->count, neighbour->count);
+}
+
 map<size_t, size_t> clusterStats(vector<Cluster*> const& clusters) {
   map<size_t, size_t> counts;
   for (Cluster* const cluster: clusters) {
@@ -94,6 +102,28 @@ map<size_t, size_t> clusterStats(vector<Cluster*> const& clusters) {
   return counts;
 }
 
+ReadClusters resolveReads(
+    vector<uint32_t>&& leafIds, vector<uint32_t> const& leafClusters,
+    vector<bool> const& maxLeaves) {
+  ReadClusters reads {std::move(leafIds)};
+  reads.representative.resize(reads.ids.size());
+
+  vector<bool> visited(leafClusters.size());
+  for (size_t i {0}; i < reads.ids.size(); i++) {
+    uint32_t const leafId {reads.ids[i]};
+    if (leafId) {
+      uint32_t const id {leafClusters[leafId]};
+      if (maxLeaves[leafId] and not visited[id]) {
+        reads.representative[i] = true;
+        visited[id] = true;
+      }
+      reads.ids[i] = id;
+    }
+  }
+
+  return reads;
+}
+
 void freeClusters(vector<Cluster*> const& clusters) {
   for (Cluster* const cluster: clusters) {
     delete cluster;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -14,7 +15,12 @@ struct Cluster {
   size_t maxCount {0};
   struct NLeaf* maxLeaf {nullptr};
   size_t size {0};
-  bool visited {false};
+};
+
+/*! Cluster assignment of every read, in input order. */
+struct ReadClusters {
+  vector<uint32_t> ids {};  //!< Cluster ID, 0 for reads that were filtered.
+  vector<bool> representative {};
 };
 
 
@@ -35,6 +41,26 @@ void assignMaxCluster(NLeaf*, Cluster* const);
  */
 void assignDirectionalCluster(NLeaf* const, Cluster*);
 
+/*! Determine whether the directional method can ever use a leaf as the larger
+ * end of an edge. This is the case if its count is at least double the
+ * smallest possible count.
+ *
+ * \param leaf Leaf node.
+ *
+ * \return True if `leaf` can dominate a neighbour.
+ */
+bool canDominate(NLeaf const* const);
+
+/*! Determine whether the directional method can follow the edge between
+ * `leaf` and `neighbour`, with `leaf` as the larger end.
+ *
+ * \param leaf Leaf node.
+ * \param neighbour Neighbour of `leaf`.
+ *
+ * \return True if `leaf` dominates `neighbour`.
+ */
+bool dominates(NLeaf const* const, NLeaf const* const);
+
 /*! Make a histogram of cluster sizes.
  *
  * \param clusters List of clusters.
@@ -43,6 +69,18 @@ void assignDirectionalCluster(NLeaf* const, Cluster*);
  */
 map<size_t, size_t> clusterStats(vector<Cluster*> const&);
 
+/*! Resolve the leaf ID of every read to a cluster ID, and select the first
+ * read of the maximum leaf of every cluster as its representative.
+ *
+ * \param leafIds Leaf ID of every read, 0 for reads that were filtered.
+ * \param leafClusters Cluster ID of every leaf.
+ * \param maxLeaves Whether a leaf is the maximum leaf of its cluster.
+ *
+ * \return Cluster assignment of every read.
+ */
+ReadClusters resolveReads(
+  vector<uint32_t>&&, vector<uint32_t> const&, vector<bool> const&);
+
 /*! Destroy a list of clusters.
  *
  * \param clusters List of clusters.
@@ -0,0 +1,255 @@
+#include <cctype>
+#include <iomanip>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "counters.h"
+
+using std::fixed;
+using std::setprecision;
+
+char const* const eventNames_[hardwareEvents] {
+  "cycles", "instructions", "cache misses", "branch misses", "page faults"};
+char const* const eventKeys_[hardwareEvents] {
+  "cycles", "instructions", "cache_misses", "branch_misses", "page_faults"};
+
+thread_local StageCounters* current_ {nullptr};
+
+
+#ifdef __linux__
+/* Open a counter for one event.
+ *
+ * \param type Event type.
+ * \param config Event.
+ *
+ * \return File descriptor, -1 if the event can not be counted.
+ */
+int openEvent_(uint32_t const type, uint64_t const config) {
+  perf_event_attr attributes {};
+  attributes.size = sizeof(attributes);
+  attributes.type = type;
+  attributes.config = config;
+  attributes.inherit = 1;
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+#endif
+
+/* Make a statistics key from a stage name. */
+string stageKey_(string const& stage) {
+  string key;
+  for (char const c: stage) {
+    if (isalnum(c)) {
+      key += tolower(c);
+    }
+    else if (not key.empty() and key.back() != '_') {
+      key += '_';
+    }
+  }
+  while (not key.empty() and key.back() == '_') {
+    key.pop_back();
+  }
+  return key;
+}
+
+/* Calculate the number of events per read. */
+double perRead_(
+    HardwareCounts const& counts, HardwareCounts::Event const event,
+    size_t const reads) {
+  return static_cast<double>(counts.values[event]) / reads;
+}
+
+/* Determine whether the instructions per cycle can be calculated. */
+bool hasIPC_(HardwareCounts const& counts) {
+  return
+    counts.available[HardwareCounts::cycles] and
+    counts.available[HardwareCounts::instructions] and
+    counts.values[HardwareCounts::cycles];
+}
+
+/* Calculate the instructions per cycle. */
+double ipc_(HardwareCounts const& counts) {
+  return
+    static_cast<double>(counts.values[HardwareCounts::instructions]) /
+    counts.values[HardwareCounts::cycles];
+}
+
+
+HardwareCounters::HardwareCounters() {
+#ifdef __linux__
+  fds_[HardwareCounts::cycles] = openEvent_(
+    PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fds_[HardwareCounts::instructions] = openEvent_(
+    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fds_[HardwareCounts::cacheMisses] = openEvent_(
+    PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  fds_[HardwareCounts::branchMisses] = openEvent_(
+    PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+  fds_[HardwareCounts::pageFaults] = openEvent_(
+    PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+#endif
+}
+
+HardwareCounters::~HardwareCounters() {
+#ifdef __linux__
+  for (int const fd: fds_) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+bool HardwareCounters::available() const {
+  for (int const fd: fds_) {
+    if (fd != -1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Read the current values of all counters. */
+HardwareCounts HardwareCounters::read_() const {
+  HardwareCounts counts;
+#ifdef __linux__
+  for (size_t i {0}; i < hardwareEvents; i++) {
+    if (fds_[i] != -1) {
+      counts.available[i] =
+        read(fds_[i], &counts.values[i], sizeof(uint64_t)) ==
+          sizeof(uint64_t);
+    }
+  }
+#endif
+  return counts;
+}
+
+void HardwareCounters::start() {
+  start_ = read_();
+}
+
+HardwareCounts HardwareCounters::stop() {
+  HardwareCounts counts {read_()};
+  for (size_t i {0}; i < hardwareEvents; i++) {
+    counts.available[i] = counts.available[i] and start_.available[i];
+    counts.values[i] -= start_.values[i];
+  }
+  return counts;
+}
+
+
+StageCounters::StageCounters() : previous_ {current_} {
+  current_ = this;
+}
+
+StageCounters::~StageCounters() {
+  current_ = previous_;
+}
+
+bool StageCounters::available() const {
+  return counters_.available();
+}
+
+vector<StageCounts> const& StageCounters::stages() const {
+  return stages_;
+}
+
+void StageCounters::start(char const stage[]) {
+  if (not depth_++) {
+    stages_.push_back({stage, {}});
+    counters_.start();
+  }
+}
+
+StageCounts const* StageCounters::stop() {
+  if (not depth_ or --depth_) {
+    return nullptr;
+  }
+  stages_.back().counts = counters_.stop();
+  return &stages_.back();
+}
+
+
+StageCounters* stageCounters() {
+  return current_;
+}
+
+void countersMessage(ofstream& log, HardwareCounts const& counts) {
+  bool first {true};
+  for (size_t i {0}; i < hardwareEvents; i++) {
+    if (counts.available[i]) {
+      log << (first ? "  " : ", ") << eventNames_[i] << ": "
+        << counts.values[i];
+      first = false;
+    }
+  }
+  if (first) {
+    log << "  hardware counters not available";
+  }
+  if (hasIPC_(counts)) {
+    log << ", IPC: " << fixed << setprecision(2) << ipc_(counts);
+  }
+  log << '\n';
+}
+
+void countersSummary(
+    ofstream& log, vector<StageCounts> const& stages, size_t const reads) {
+  if (not reads) {
+    return;
+  }
+
+  log << "Hardware counters per read:\n";
+  for (StageCounts const& stage: stages) {
+    log << "  " << stage.stage << ':';
+    char const* separator {" "};
+    if (hasIPC_(stage.counts)) {
+      log << separator << "IPC " << fixed << setprecision(2)
+        << ipc_(stage.counts);
+      separator = ", ";
+    }
+    for (HardwareCounts::Event const event: {
+        HardwareCounts::cacheMisses, HardwareCounts::branchMisses,
+        HardwareCounts::pageFaults}) {
+      if (stage.counts.available[event]) {
+        log << separator << fixed << setprecision(3)
+          << perRead_(stage.counts, event, reads) << ' '
+          << eventNames_[event];
+        separator = ", ";
+      }
+    }
+    log << '\n';
+  }
+  log.flush();
+}
+
+void writeCounters(
+    ofstream& output, vector<StageCounts> const& stages,
+    size_t const reads) {
+  for (StageCounts const& stage: stages) {
+    string const key {stageKey_(stage.stage)};
+    for (size_t i {0}; i < hardwareEvents; i++) {
+      if (stage.counts.available[i]) {
+        output << key << '_' << eventKeys_[i] << ": "
+          << stage.counts.values[i] << '\n';
+      }
+    }
+    if (hasIPC_(stage.counts)) {
+      output << key << "_ipc: " << ipc_(stage.counts) << '\n';
+    }
+    if (reads) {
+      for (HardwareCounts::Event const event: {
+          HardwareCounts::cacheMisses, HardwareCounts::branchMisses,
+          HardwareCounts::pageFaults}) {
+        if (stage.counts.available[event]) {
+          output << key << '_' << eventKeys_[event] << "_per_read: "
+            << perRead_(stage.counts, event, reads) << '\n';
+        }
+      }
+    }
+  }
+}
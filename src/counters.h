@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::ofstream;
+using std::string;
+using std::vector;
+
+size_t const hardwareEvents {5};
+
+/*! Hardware event counts. Events that could not be counted are marked as
+ * unavailable.
+ */
+struct HardwareCounts {
+  enum Event {cycles, instructions, cacheMisses, branchMisses, pageFaults};
+
+  uint64_t values[hardwareEvents] {};
+  bool available[hardwareEvents] {};
+};
+
+/*! Hardware event counts of one stage. */
+struct StageCounts {
+  string stage {};
+  HardwareCounts counts {};
+};
+
+
+/*! Hardware event counters of the calling thread and the threads it starts,
+ * read with `perf_event_open`. Every event is opened separately, so events
+ * that are not supported or not permitted do not affect the others.
+ *
+ * The counts of other threads are only included once they have finished.
+ */
+class HardwareCounters {
+public:
+  HardwareCounters();
+  HardwareCounters(HardwareCounters const&) = delete;
+  ~HardwareCounters();
+
+  HardwareCounters& operator=(HardwareCounters const&) = delete;
+
+  /*! Determine whether any event can be counted.
+   *
+   * \return `true` if at least one event can be counted.
+   */
+  bool available() const;
+
+  /*! Start a measurement. */
+  void start();
+
+  /*! Finish a measurement.
+   *
+   * \return Counts since the last call to `start()`.
+   */
+  HardwareCounts stop();
+
+private:
+  HardwareCounts read_() const;
+
+  int fds_[hardwareEvents] {-1, -1, -1, -1, -1};
+  HardwareCounts start_ {};
+};
+
+
+/*! Count hardware events in every stage that is logged by the calling thread
+ * with `startMessage()` and `endMessage()`, for as long as this object
+ * exists. Nested stages are counted as part of the outermost one.
+ */
+class StageCounters {
+public:
+  StageCounters();
+  StageCounters(StageCounters const&) = delete;
+  ~StageCounters();
+
+  StageCounters& operator=(StageCounters const&) = delete;
+
+  /*! Determine whether any event can be counted.
+   *
+   * \return `true` if at least one event can be counted.
+   */
+  bool available() const;
+
+  /*! Get the counts of all completed stages.
+   *
+   * \return Counts per stage.
+   */
+  vector<StageCounts> const& stages() const;
+
+  /*! Start counting a stage.
+   *
+   * \param stage Stage name.
+   */
+  void start(char const[]);
+
+  /*! Stop counting a stage.
+   *
+   * \return Counts of the stage if it is an outermost stage, `nullptr`
+   *   otherwise.
+   */
+  StageCounts const* stop();
+
+private:
+  HardwareCounters counters_ {};
+  vector<StageCounts> stages_ {};
+  size_t depth_ {0};
+  StageCounters* previous_ {nullptr};
+};
+
+
+/*! Get the stage counters of the calling thread.
+ *
+ * \return Stage counters, `nullptr` if no events are counted.
+ */
+StageCounters* stageCounters();
+
+/*! Write hardware event counts to a log.
+ *
+ * \param log Log file.
+ * \param counts Counts.
+ */
+void countersMessage(ofstream&, HardwareCounts const&);
+
+/*! Write the instructions per cycle and the events per read of every stage
+ * to a log.
+ *
+ * \param log Log file.
+ * \param stages Counts per stage.
+ * \param reads Number of reads.
+ */
+void countersSummary(ofstream&, vector<StageCounts> const&, size_t const);
+
+/*! Write hardware event counts per stage to a statistics file.
+ *
+ * \param output Statistics file.
+ * \param stages Counts per stage.
+ * \param reads Number of reads.
+ */
+void writeCounters(ofstream&, vector<StageCounts> const&, size_t const);
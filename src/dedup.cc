@@ -0,0 +1,843 @@
+#include <cmath>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "counters.h"
+#include "dedup.h"
+#include "deduplicator.h"
+#include "estimate.h"
+#include "grouped.h"
+#include "log.h"
+#include "sidecar.h"
+#include "state.h"
+#include "whitelist.h"
+
+using std::filesystem::absolute;
+using std::filesystem::create_directories;
+using std::filesystem::exists;
+using std::filesystem::rename;
+using std::ifstream;
+using std::invalid_argument;
+using std::ios;
+using std::llround;
+using std::mt19937_64;
+using std::optional;
+using std::ostringstream;
+using std::tie;
+using std::tuple;
+using std::uniform_int_distribution;
+
+size_t const batchSize {1 << 16};
+string const stateMagic {"HUMID state 1"};
+size_t const sortMemory {size_t {1} << 30};
+
+/*! Peek at the header of the first read, to determine the size of the UMI, if
+ * any.
+ *
+ * \param filename Input file name.
+ *
+ * \return Size of the UMI in the header.
+ */
+size_t peekUMI(string const filename) {
+  FastqReader reader {filename.c_str()};
+  Read* read {reader.read()};
+
+  size_t umiSize {extractUMI(read).size()};
+
+  delete read;
+
+  return umiSize;
+}
+
+/*! Peek at the header of the first read, to determine the size of the cell
+ * barcode, if any.
+ *
+ * \param filename Input file name.
+ *
+ * \return Size of the cell barcode in the header.
+ */
+size_t peekBarcode(string const filename) {
+  FastqReader reader {filename.c_str()};
+  Read* read {reader.read()};
+
+  size_t barcodeSize {extractBarcode(read).size()};
+
+  delete read;
+
+  return barcodeSize;
+}
+
+/*! Pre-compute the nucleotides to take from the UMI header, and from each of
+ * the input files. If read structures are given, the UMI is taken from the
+ * reads instead of from the header.
+ */
+tuple<size_t, vector<size_t>> preCompute(
+    vector<string> const files, size_t const wordLength,
+    vector<ReadStructure> const& structures) {
+  // Peek at the header of the first read in the first file to get the UMI size.
+  size_t headerUMISize {
+    structures.empty() ? peekUMI(files.front()) : umiLength(structures)};
+
+  // Ensure we do not take a negative amount of nucleotides from the files.
+  size_t fromFile {0};
+  if (wordLength > headerUMISize) {
+    fromFile = wordLength - headerUMISize;
+  }
+
+  // Calculate how many nucleotides to take from each read. Any remainder will
+  // be taken from the last file.
+  vector<size_t> ntToTake {ntFromFile(files.size(), fromFile)};
+
+  // Ensure we do not take more than `wordLength` from the UMI header.
+  if (wordLength < headerUMISize) {
+    headerUMISize = wordLength;
+  }
+
+  return tuple<size_t, vector<size_t>>(headerUMISize, ntToTake);
+}
+
+/*! Add words extracted from reads.
+ *
+ * \param dedup Deduplicator.
+ * \param blocks Blocks of reads.
+ * \param maker Word extraction.
+ */
+template <class T>
+void addWords(
+    Deduplicator& dedup, generator<ReadBlock<T>> blocks,
+    WordMaker const& maker) {
+  // The words are added in batches, so they can be divided over threads.
+  // Only the last block can be partially filled, so every batch holds a
+  // whole number of blocks.
+  static_assert(batchSize % readBlockSize == 0);
+  vector<Word> batch(batchSize);
+  size_t size {0};
+  for (ReadBlock<T> const& block: blocks) {
+    maker.make(block, batch.data() + size);
+    size += block.size;
+    if (size == batch.size()) {
+      dedup.add(batch);
+      size = 0;
+    }
+  }
+  batch.resize(size);
+  dedup.add(batch);
+}
+
+/*! Add words extracted from FastQ files.
+ *
+ * \param dedup Deduplicator.
+ * \param files Input file names.
+ * \param maker Word extraction.
+ * \param threads Number of threads.
+ * \param log Log handle.
+ */
+void readData(
+    Deduplicator& dedup, vector<string> const files, WordMaker const& maker,
+    size_t const threads, ofstream& log) {
+  time_t start {startMessage(log, "Reading data")};
+  if (recordFiles(files)) {
+    addWords(dedup, readRecords(files, threads), maker);
+  }
+  else {
+    addWords(dedup, readFiles(files), maker);
+  }
+  endMessage(log, start);
+
+  if (maker.specialised()) {
+    log << "  specialised word extraction\n";
+  }
+}
+
+/*! Add a uniform random subsample of words extracted from reads.
+ *
+ * \param dedup Deduplicator.
+ * \param blocks Blocks of reads.
+ * \param maker Word extraction.
+ * \param sampleSize Maximum number of words to add.
+ *
+ * \return Total number of reads.
+ */
+template <class T>
+size_t sampleWords(
+    Deduplicator& dedup, generator<ReadBlock<T>> blocks,
+    WordMaker const& maker, size_t const sampleSize) {
+  // Reservoir sampling with a fixed seed, so the estimate is reproducible.
+  vector<Word> reservoir;
+  mt19937_64 random {0};
+  size_t total {0};
+  for (ReadBlock<T> const& block: blocks) {
+    for (size_t j {0}; j < block.size; j++) {
+      if (total < sampleSize) {
+        reservoir.emplace_back();
+        maker.make(block.reads[j], reservoir.back());
+      }
+      else {
+        uniform_int_distribution<size_t> position {0, total};
+        size_t const i {position(random)};
+        if (i < sampleSize) {
+          maker.make(block.reads[j], reservoir[i]);
+        }
+      }
+      total++;
+    }
+  }
+
+  for (Word const& word: reservoir) {
+    dedup.add(word);
+  }
+
+  return total;
+}
+
+/*! Add a uniform random subsample of words extracted from FastQ files.
+ *
+ * \param dedup Deduplicator.
+ * \param files Input file names.
+ * \param maker Word extraction.
+ * \param sampleSize Maximum number of words to add.
+ * \param threads Number of threads.
+ * \param log Log handle.
+ *
+ * \return Total number of reads.
+ */
+size_t sampleData(
+    Deduplicator& dedup, vector<string> const files, WordMaker const& maker,
+    size_t const sampleSize, size_t const threads, ofstream& log) {
+  time_t start {startMessage(log, "Sampling data")};
+  size_t total {0};
+  if (recordFiles(files)) {
+    total = sampleWords(
+      dedup, readRecords(files, threads), maker, sampleSize);
+  }
+  else {
+    total = sampleWords(dedup, readFiles(files), maker, sampleSize);
+  }
+  endMessage(log, start);
+
+  log << "  sampled: " << dedup.stats().total << " of " << total << "\n";
+
+  return total;
+}
+
+/*! Write the representative read of every cluster.
+ *
+ * \param blocks Blocks of reads.
+ * \param clusters Cluster assignment of every read.
+ * \param outFiles Output files.
+ * \param trimmer Read trimming, if any.
+ * \param ordinal Index of the first read in `clusters`.
+ */
+template <class T>
+void writeRepresentatives(
+    generator<ReadBlock<T>> blocks, ReadClusters const& clusters,
+    vector<OutputFile*> const& outFiles, ReadTrimmer* const trimmer,
+    size_t& ordinal) {
+  auto const write {[&outFiles](auto const& read) {
+    for (size_t i {0}; i < read.size(); i++) {
+      writeRead(outFiles[i], read[i]);
+    }
+  }};
+
+  for (ReadBlock<T> const& block: blocks) {
+    for (size_t j {0}; j < block.size; j++) {
+      if (not clusters.representative[ordinal++]) {
+        continue;
+      }
+      if (trimmer) {
+        write(trimmer->trim(block.reads[j]));
+      }
+      else {
+        write(block.reads[j]);
+      }
+    }
+  }
+}
+
+/*! Filter FastQ files for duplicates.
+ *
+ * \param groups Input file names of every run, the output file names are
+ *   based on those of the last run.
+ * \param clusters Cluster assignment of every read.
+ * \param trim Read structure of every file, used to trim the reads, empty to
+ *   write the reads unchanged.
+ * \param dirName Output directory.
+ * \param threads Number of threads.
+ * \param log Log handle.
+ */
+void writeFiltered(
+    vector<vector<string>> const& groups, ReadClusters const& clusters,
+    vector<ReadStructure> const& trim, string const dirName,
+    size_t const threads, ofstream& log) {
+  time_t start {startMessage(log, "Writing filtered results")};
+
+  vector<OutputFile*> outFiles;
+  for (string const& name: makeFileNames(
+      groups.back(), dirName, "dedup")) {
+    outFiles.push_back(new OutputFile(name));
+  }
+
+  ReadTrimmer readTrimmer {trim};
+  ReadTrimmer* const trimmer {trim.empty() ? nullptr : &readTrimmer};
+  size_t ordinal {0};
+  for (vector<string> const& files: groups) {
+    if (recordFiles(files)) {
+      writeRepresentatives(
+        readRecords(files, threads), clusters, outFiles, trimmer, ordinal);
+    }
+    else {
+      writeRepresentatives(
+        readFiles(files), clusters, outFiles, trimmer, ordinal);
+    }
+  }
+
+  for (OutputFile* const w: outFiles) {
+    delete w;
+  }
+
+  endMessage(log, start);
+}
+
+/*! Write all reads, annotated with their cluster IDs.
+ *
+ * \param blocks Blocks of reads.
+ * \param clusters Cluster assignment of every read.
+ * \param outFiles Output files.
+ * \param trimmer Read trimming, if any.
+ * \param ordinal Index of the first read in `clusters`.
+ */
+template <class T>
+void writeClusterIds(
+    generator<ReadBlock<T>> blocks, ReadClusters const& clusters,
+    vector<OutputFile*> const& outFiles, ReadTrimmer* const trimmer,
+    size_t& ordinal) {
+  auto const write {[&outFiles](auto const& read, uint32_t const id) {
+    for (size_t i {0}; i < read.size(); i++) {
+      writeAnnotatedRead(outFiles[i], read[i], id);
+    }
+  }};
+
+  for (ReadBlock<T> const& block: blocks) {
+    for (size_t j {0}; j < block.size; j++) {
+      // Cluster ID 0 is special, and reserved for reads that could not be
+      // clustered.
+      uint32_t const cluster_id {clusters.ids[ordinal++]};
+
+      if (trimmer) {
+        write(trimmer->trim(block.reads[j]), cluster_id);
+      }
+      else {
+        write(block.reads[j], cluster_id);
+      }
+    }
+  }
+}
+
+/*! Annotate FastQ files with cluster IDs.
+ *
+ * \param groups Input file names of every run, the output file names are
+ *   based on those of the last run.
+ * \param clusters Cluster assignment of every read.
+ * \param trim Read structure of every file, used to trim the reads, empty to
+ *   write the reads unchanged.
+ * \param dirName Output directory.
+ * \param threads Number of threads.
+ * \param log Log handle.
+ */
+void writeAnnotated(
+    vector<vector<string>> const& groups, ReadClusters const& clusters,
+    vector<ReadStructure> const& trim, string const dirName,
+    size_t const threads, ofstream& log) {
+  time_t start {startMessage(log, "Writing annotated results")};
+
+  vector<OutputFile*> outFiles;
+  for (string const& name: makeFileNames(
+      groups.back(), dirName, "annotated")) {
+    outFiles.push_back(new OutputFile(name));
+  }
+
+  ReadTrimmer readTrimmer {trim};
+  ReadTrimmer* const trimmer {trim.empty() ? nullptr : &readTrimmer};
+  size_t ordinal {0};
+  for (vector<string> const& files: groups) {
+    if (recordFiles(files)) {
+      writeClusterIds(
+        readRecords(files, threads), clusters, outFiles, trimmer, ordinal);
+    }
+    else {
+      writeClusterIds(
+        readFiles(files), clusters, outFiles, trimmer, ordinal);
+    }
+  }
+
+  for (OutputFile* const w: outFiles) {
+    delete w;
+  }
+
+  endMessage(log, start);
+}
+
+/*! Collect all reads, annotated with their cluster IDs, for grouping.
+ *
+ * \param blocks Blocks of reads.
+ * \param clusters Cluster assignment of every read.
+ * \param sorter Sorter.
+ * \param trimmer Read trimming, if any.
+ * \param ordinal Index of the first read in `clusters`.
+ */
+template <class T>
+void sortClusterIds(
+    generator<ReadBlock<T>> blocks, ReadClusters const& clusters,
+    ClusterSorter& sorter, ReadTrimmer* const trimmer, size_t& ordinal) {
+  auto const annotate {[](auto const& read, uint32_t const id) {
+    vector<string> records(read.size());
+    for (size_t i {0}; i < read.size(); i++) {
+      appendAnnotatedRead(records[i], read[i], id);
+    }
+    return records;
+  }};
+
+  for (ReadBlock<T> const& block: blocks) {
+    for (size_t j {0}; j < block.size; j++) {
+      uint32_t const cluster_id {clusters.ids[ordinal]};
+
+      vector<string> records;
+      if (trimmer) {
+        records = annotate(trimmer->trim(block.reads[j]), cluster_id);
+      }
+      else {
+        records = annotate(block.reads[j], cluster_id);
+      }
+      sorter.add(
+        cluster_id, clusters.representative[ordinal++], std::move(records));
+    }
+  }
+}
+
+/*! Write all reads, annotated with their cluster IDs and grouped by cluster.
+ *
+ * \param groups Input file names of every run, the output file names are
+ *   based on those of the last run.
+ * \param clusters Cluster assignment of every read.
+ * \param trim Read structure of every file, used to trim the reads, empty to
+ *   write the reads unchanged.
+ * \param dirName Output directory.
+ * \param threads Number of threads.
+ * \param log Log handle.
+ */
+void writeGrouped(
+    vector<vector<string>> const& groups, ReadClusters const& clusters,
+    vector<ReadStructure> const& trim, string const dirName,
+    size_t const threads, ofstream& log) {
+  time_t start {startMessage(log, "Writing grouped results")};
+
+  ClusterSorter sorter {dirName, sortMemory};
+  ReadTrimmer readTrimmer {trim};
+  ReadTrimmer* const trimmer {trim.empty() ? nullptr : &readTrimmer};
+  size_t ordinal {0};
+  for (vector<string> const& files: groups) {
+    if (recordFiles(files)) {
+      sortClusterIds(
+        readRecords(files, threads), clusters, sorter, trimmer, ordinal);
+    }
+    else {
+      sortClusterIds(
+        readFiles(files), clusters, sorter, trimmer, ordinal);
+    }
+  }
+
+  vector<OutputFile*> outFiles;
+  for (string const& name: makeFileNames(
+      groups.back(), dirName, "grouped")) {
+    outFiles.push_back(new OutputFile(name));
+  }
+
+  sorter.write(outFiles);
+
+  for (OutputFile* const w: outFiles) {
+    delete w;
+  }
+
+  endMessage(log, start);
+  log << "  runs: " << sorter.runs() << "\n";
+}
+
+/*! Write duplicate and cluster size histograms to files.
+ *
+ * \param stats Statistics.
+ * \param dirName Output directory.
+ */
+void writeHistograms(DedupStats const& stats, string const dirName) {
+  ofstream output(addDir("counts.dat", dirName), ios::out | ios::binary);
+  for (pair<size_t const, size_t> const& count: stats.counts) {
+    output << count.first << ' ' << count.second << '\n';
+  }
+  output.close();
+
+  output.open(addDir("neigh.dat", dirName), ios::out | ios::binary);
+  for (pair<size_t const, size_t> const& count: stats.neighbours) {
+    output << count.first << ' ' << count.second << '\n';
+  }
+  output.close();
+
+  output.open(addDir("clusters.dat", dirName), ios::out | ios::binary);
+  for (pair<size_t const, size_t> const& count: stats.clusterSizes) {
+    output << count.first << ' ' << count.second << '\n';
+  }
+  output.close();
+}
+
+/*! Write statistics to files.
+ *
+ * \param stats Statistics.
+ * \param complexity Low complexity filter was used.
+ * \param dirName Output directory.
+ * \param counters Hardware event counts per stage, if any.
+ */
+void writeStatistics(
+    DedupStats const& stats, bool const complexity, string const dirName,
+    StageCounters const* const counters) {
+  writeHistograms(stats, dirName);
+
+  ofstream output(addDir("stats.dat", dirName), ios::out | ios::binary);
+  output << "total: " << stats.total << '\n';
+  output << "usable: " << stats.usable << '\n';
+  if (complexity) {
+    output << "low_complexity: " << stats.lowComplexity << '\n';
+  }
+  output << "unique: " << stats.unique << '\n';
+  output << "clusters: " << stats.clusters << '\n';
+  writeMemory(output, stats.memory);
+  if (counters) {
+    writeCounters(output, counters->stages(), stats.total);
+  }
+  output.close();
+}
+
+/*! Write statistics of a subsample, extrapolated to the full data set, to
+ * files. The histograms are those of the subsample.
+ *
+ * \param stats Statistics of the subsample.
+ * \param total Number of reads in the full data set.
+ * \param complexity Low complexity filter was used.
+ * \param dirName Output directory.
+ */
+void writeEstimate(
+    DedupStats const& stats, size_t const total, bool const complexity,
+    string const dirName) {
+  writeHistograms(stats, dirName);
+
+  size_t usable {0};
+  size_t lowComplexity {0};
+  if (stats.total) {
+    usable = llround(
+      static_cast<double>(total) * stats.usable / stats.total);
+    lowComplexity = llround(
+      static_cast<double>(total) * stats.lowComplexity / stats.total);
+  }
+  // Low complexity reads are not clustered.
+  size_t const sampled {stats.usable - stats.lowComplexity};
+  Estimate unique {
+    extrapolate(stats.counts, sampled, usable - lowComplexity)};
+  Estimate clusters {
+    extrapolate(stats.clusterSizes, sampled, usable - lowComplexity)};
+
+  ofstream output(addDir("stats.dat", dirName), ios::out | ios::binary);
+  output << "total: " << total << '\n';
+  output << "usable: " << usable << '\n';
+  if (complexity) {
+    output << "low_complexity: " << lowComplexity << '\n';
+  }
+  output << "unique: " << llround(unique.value) << '\n';
+  output << "unique_lower: " << llround(unique.lower) << '\n';
+  output << "unique_upper: " << llround(unique.upper) << '\n';
+  output << "clusters: " << llround(clusters.value) << '\n';
+  output << "clusters_lower: " << llround(clusters.lower) << '\n';
+  output << "clusters_upper: " << llround(clusters.upper) << '\n';
+  output << "sampled: " << stats.total << '\n';
+  writeMemory(output, stats.memory);
+  output.close();
+}
+
+/*! Describe the settings that must be equal for all runs that share a state
+ * file.
+ *
+ * \param wordLength Read length.
+ * \param distance Maximum distance between reads.
+ * \param budgets Distance budget for every segment of a word.
+ * \param edit Use the Levenshtein distance.
+ * \param maximum Use the maximum clustering method.
+ * \param complexity Low complexity threshold.
+ * \param headerUMISize Nucleotides to take from the UMI header.
+ * \param ntToTake Nucleotides to take from each file.
+ * \param whitelist UMI whitelist file name.
+ * \param barcodeSize Nucleotides to take from the cell barcode.
+ * \param structures Read structure of every file.
+ *
+ * \return Settings.
+ */
+string stateSettings(
+    size_t const wordLength, size_t const distance, string const budgets,
+    bool const edit, bool const maximum, size_t const complexity,
+    size_t const headerUMISize, vector<size_t> const& ntToTake,
+    string const whitelist, size_t const barcodeSize,
+    string const structures) {
+  ostringstream settings;
+  settings << "n=" << wordLength << " m=" << distance << " b=" << budgets
+    << " e=" << edit << " x=" << maximum << " c=" << complexity
+    << " header=" << headerUMISize << " files=";
+  for (size_t const nt: ntToTake) {
+    settings << nt << ',';
+  }
+  if (not whitelist.empty()) {
+    settings << " w=" << whitelist;
+  }
+  if (barcodeSize) {
+    settings << " barcode=" << barcodeSize;
+  }
+  if (not structures.empty()) {
+    settings << " f=" << structures;
+  }
+  return settings.str();
+}
+
+/*! Load a UMI whitelist. The whitelisted UMIs must cover the start of every
+ * word, i.e., the UMI in the header if there is one, and the start of the
+ * first read otherwise.
+ *
+ * \param whitelist Whitelist.
+ * \param fileName Whitelist file name.
+ * \param distance Maximum number of corrected mismatches.
+ * \param headerUMISize Nucleotides to take from the UMI header.
+ * \param wordLength Word length.
+ * \param log Log handle.
+ */
+void loadWhitelist(
+    optional<Whitelist>& whitelist, string const fileName,
+    size_t const distance, size_t const headerUMISize,
+    size_t const wordLength, ofstream& log) {
+  time_t start {startMessage(log, "Loading whitelist")};
+  whitelist.emplace(fileName, distance);
+  if (
+      (headerUMISize and whitelist->length() != headerUMISize) or
+      whitelist->length() > wordLength) {
+    throw invalid_argument(
+      "whitelisted UMIs do not match the UMIs in the reads");
+  }
+  endMessage(log, start);
+
+  log << "  UMI length: " << whitelist->length() << ", "
+    << whitelist->size() << " correctable sequences\n";
+}
+
+/*! Restore the state of previous runs, if any.
+ *
+ * \param dedup Deduplicator.
+ * \param fileName State file.
+ * \param settings Settings of this run.
+ * \param log Log handle.
+ *
+ * \return Input file names of every previous run.
+ */
+vector<vector<string>> loadState(
+    Deduplicator& dedup, string const fileName, string const settings,
+    ofstream& log) {
+  vector<vector<string>> groups;
+  if (not exists(fileName)) {
+    return groups;
+  }
+
+  time_t start {startMessage(log, "Loading state")};
+  ifstream input(fileName.c_str(), ios::in | ios::binary);
+  if (readString(input) != stateMagic) {
+    throw invalid_argument("not a state file: " + fileName);
+  }
+  if (readString(input) != settings) {
+    throw invalid_argument(
+      "state file was made with different settings: " + fileName);
+  }
+  groups.resize(readValue<uint64_t>(input));
+  for (vector<string>& files: groups) {
+    files.resize(readValue<uint64_t>(input));
+    for (string& name: files) {
+      name = readString(input);
+    }
+  }
+  dedup.load(input);
+  endMessage(log, start);
+
+  log << "  previous runs: " << groups.size() << "\n";
+
+  return groups;
+}
+
+/*! Write the header of a state file.
+ *
+ * \param output State file.
+ * \param settings Settings of this run.
+ * \param groups Input file names of every run.
+ */
+void writeStateHeader(
+    ostream& output, string const settings,
+    vector<vector<string>> const& groups) {
+  writeString(output, stateMagic);
+  writeString(output, settings);
+  writeValue<uint64_t>(output, groups.size());
+  for (vector<string> const& files: groups) {
+    writeValue<uint64_t>(output, files.size());
+    for (string const& name: files) {
+      writeString(output, name);
+    }
+  }
+}
+
+void humid(
+    size_t const wordLength, size_t const distance, string const logName,
+    string const dirName, bool const runStats, bool const filter,
+    bool const annotate, bool const sidecar, bool const grouped,
+    bool const edit, bool const maximum, bool const radix,
+    bool const counters, bool const barcode, bool const trim,
+    string const budgets, string const whitelistName,
+    string const structureSpecs, size_t const complexity,
+    size_t const threads, size_t const sampleSize, string const state,
+    vector<string> const files) {
+  if (sampleSize and not state.empty()) {
+    throw invalid_argument(
+      "a subsample can not be combined with a state file");
+  }
+
+  ofstream log(logName.c_str(), ios::out | ios::binary);
+
+  optional<StageCounters> stages;
+  if (counters) {
+    stages.emplace();
+    if (not stages->available()) {
+      log << "Hardware counters not available\n";
+    }
+  }
+
+  // Pre calculate some values so that we do not have to re-calculate them for
+  // every single read.
+  size_t headerUMISize;
+  vector<size_t> ntToTake;
+  vector<ReadStructure> const structures {
+    parseStructures(structureSpecs, files.size())};
+  if (trim and structures.empty()) {
+    throw invalid_argument("trimming needs a read structure");
+  }
+  tie(headerUMISize, ntToTake) = preCompute(files, wordLength, structures);
+  size_t barcodeSize {0};
+  if (barcode) {
+    barcodeSize = peekBarcode(files.front());
+    if (not barcodeSize) {
+      throw invalid_argument("no cell barcode found in the header");
+    }
+  }
+
+  time_t start {startMessage(log, "Determing nucleotides to take")};
+  endMessage(log, start);
+
+  log << (structures.empty() ? "  header: " : "  in-read UMI: ")
+    << headerUMISize;
+  if (barcodeSize) {
+    log << "\n  barcode: " << barcodeSize;
+  }
+  for (size_t i {0}; i < ntToTake.size(); ++i) {
+    log << "\n  " << files[i] << ": " << ntToTake[i];
+  }
+  log << "\n";
+
+  // Corrected UMIs must match exactly, so the neighbour search only applies
+  // to the rest of the word.
+  Segments segments {makeSegments(headerUMISize, ntToTake, budgets, distance)};
+  optional<Whitelist> whitelist;
+  if (not whitelistName.empty()) {
+    loadWhitelist(
+      whitelist, whitelistName, distance, headerUMISize, wordLength, log);
+    segments = exactPrefix(segments, whitelist->length());
+  }
+
+  // The cell barcode is appended to every word as a segment that must match
+  // exactly, so the reads of every cell are deduplicated in partitions of
+  // their own.
+  if (barcodeSize) {
+    segments.lengths.push_back(barcodeSize);
+    segments.budgets.push_back(0);
+  }
+
+  WordMaker const maker {
+    ntToTake, headerUMISize, whitelist ? &*whitelist : nullptr,
+    barcodeSize, structures};
+  Deduplicator dedup {segments, edit, maximum, radix, threads, complexity};
+
+  if (sampleSize) {
+    size_t total {
+      sampleData(dedup, files, maker, sampleSize, threads, log)};
+    dedup.finalize(true, log);
+
+    create_directories(dirName);
+    writeEstimate(dedup.stats(), total, complexity, dirName);
+
+    log.close();
+    return;
+  }
+
+  vector<vector<string>> groups;
+  if (state.empty()) {
+    groups.push_back(files);
+    readData(dedup, files, maker, threads, log);
+    dedup.finalize(runStats, log);
+  }
+  else {
+    string const settings {stateSettings(
+      wordLength, distance, budgets, edit, maximum, complexity,
+      headerUMISize, ntToTake, whitelistName, barcodeSize,
+      structureSpecs)};
+    groups = loadState(dedup, state, settings, log);
+    groups.emplace_back();
+    for (string const& name: files) {
+      groups.back().push_back(absolute(name).string());
+    }
+
+    readData(dedup, files, maker, threads, log);
+
+    // The previous state is only replaced when the new one is complete.
+    string const tmpName {state + ".tmp"};
+    ofstream output(tmpName.c_str(), ios::out | ios::binary);
+    writeStateHeader(output, settings, groups);
+    dedup.finalize(runStats, log, &output);
+    output.close();
+    rename(tmpName, state);
+  }
+
+  create_directories(dirName);
+  vector<ReadStructure> const trimmed {
+    trim ? structures : vector<ReadStructure> {}};
+  if (filter) {
+    writeFiltered(groups, dedup.reads(), trimmed, dirName, threads, log);
+  }
+  if (annotate) {
+    writeAnnotated(groups, dedup.reads(), trimmed, dirName, threads, log);
+  }
+  if (grouped) {
+    writeGrouped(groups, dedup.reads(), trimmed, dirName, threads, log);
+  }
+  if (sidecar) {
+    start = startMessage(log, "Writing cluster IDs");
+    writeSidecar(addDir("cluster_ids.bin", dirName), dedup.reads());
+    endMessage(log, start);
+  }
+  if (runStats) {
+    writeStatistics(
+      dedup.stats(), complexity, dirName, stages ? &*stages : nullptr);
+  }
+  if (stages) {
+    countersSummary(log, stages->stages(), dedup.stats().total);
+  }
+
+  log.close();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/*! Determine duplicates.
+ *
+ * \param wordLength Read length.
+ * \param distance Maximum distance between reads.
+ * \param logName Log file.
+ * \param dirName Output directory.
+ * \param runStats
+ * \param write
+ * \param sidecar Write the cluster ID of every read to a binary file.
+ * \param grouped Write annotated FastQ files grouped by cluster.
+ * \param radix Use a path-compressed trie to store the words.
+ * \param counters Report hardware event counts of every stage.
+ * \param barcode Only merge reads with the same cell barcode in the header.
+ * \param trim Remove the in-read UMIs from the written reads.
+ * \param budgets Distance budget for every segment of a word.
+ * \param whitelist UMI whitelist file name, empty to disable.
+ * \param structures Read structure of every file, empty to use the UMI in
+ *   the header.
+ * \param complexity Set reads aside if a single nucleotide makes up more than
+ *   this percentage of their word, 0 to keep all reads.
+ * \param threads Number of threads.
+ * \param sampleSize Only estimate the statistics on a subsample of this
+ *   many reads, 0 to process all reads.
+ * \param state State file for incremental runs, empty to disable.
+ * \param files FastQ files.
+ */
+void humid(
+  size_t const, size_t const, string const, string const, bool const,
+  bool const, bool const, bool const, bool const, bool const, bool const,
+  bool const, bool const, bool const, bool const, string const, string const,
+  string const, size_t const, size_t const, size_t const, string const,
+  vector<string> const);
@@ -0,0 +1,1040 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../lib/trie/src/trie.tcc"
+
+#include "deduplicator.h"
+#include "leaf.h"
+#include "log.h"
+#include "memory.h"
+#include "pairs.tcc"
+#include "pool.h"
+#include "radix.tcc"
+#include "shards.tcc"
+#include "state.h"
+
+using std::accumulate;
+using std::declval;
+using std::invalid_argument;
+using std::logic_error;
+using std::max;
+using std::remove_pointer_t;
+using std::sort;
+using std::tie;
+using std::tuple;
+using std::unique;
+using std::unordered_map;
+using std::unordered_set;
+
+/*! Calculate neighbours for every word in a trie.
+ *
+ * All pairs of neighbours are found in one joint traversal of a flat copy of
+ * the words (see `hammingPairs()`), and are linked as they are found. This
+ * gives every word its neighbours in walk order, as one asymmetric Hamming
+ * search per word, in walk order, would do.
+ *
+ * \param trie Trie.
+ * \param segments Word segments.
+ *
+ * \return Number of unique words.
+ */
+template <class WordStore>
+size_t findHammingNeighbours(
+    WordStore const& trie, Segments const& segments) {
+  vector<NLeaf*> leaves;
+  vector<uint8_t> words;
+  size_t length {0};
+  for (Result<NLeaf> const& walkResult: trie.walk()) {
+    leaves.push_back(walkResult.leaf);
+    words.insert(
+      words.end(), walkResult.path.begin(), walkResult.path.end());
+    length = walkResult.path.size();
+  }
+
+  hammingPairs(
+      words, length, fuzzyDistance(segments),
+      [&](uint32_t const i, uint32_t const j) {
+    span<uint8_t const> const a {words.data() + i * length, length};
+    span<uint8_t const> const b {words.data() + j * length, length};
+    if (withinBudgets(a, b, segments)) {
+      leaves[i]->neighbours.push_back(leaves[j]);
+      leaves[j]->neighbours.push_back(leaves[i]);
+    }
+  });
+
+  return leaves.size();
+}
+
+/*! Calculate neighbours for every word in a trie, keeping only the edges that
+ * can be used by the directional clustering method.
+ *
+ * An edge is only followed when the count of one leaf is at least double the
+ * count of the other, so we only search the neighbourhood of leaves that can
+ * dominate a neighbour, and only link the neighbours they dominate. The
+ * dominating leaves are visited in walk order, so the relative order of the
+ * remaining edges is the same as in `findHammingNeighbours`, which keeps the
+ * clusters identical.
+ *
+ * \param trie Trie.
+ * \param segments Word segments.
+ *
+ * \return Number of unique words.
+ */
+template <class WordStore>
+size_t findDirectionalNeighbours(
+    WordStore const& trie, Segments const& segments) {
+  size_t unique {0};
+  for (Result<NLeaf> const& walkResult: trie.walk()) {
+    if (canDominate(walkResult.leaf)) {
+      for (Result<NLeaf> const& hammingResult: trie.hamming(
+          walkResult.path, fuzzyDistance(segments))) {
+        if (
+            dominates(walkResult.leaf, hammingResult.leaf) and
+            withinBudgets(walkResult.path, hammingResult.path, segments)) {
+          walkResult.leaf->neighbours.push_back(hammingResult.leaf);
+          hammingResult.leaf->neighbours.push_back(walkResult.leaf);
+        }
+      }
+    }
+    unique++;
+  }
+
+  return unique;
+}
+
+/*! Sort Levenshtein search results in lexicographic order, and keep one
+ * result per leaf. A search does not yield its results in lexicographic
+ * order, and can find a word along more than one edit path.
+ *
+ * \param results Search results.
+ */
+void sortResults(vector<Result<NLeaf>>& results) {
+  sort(
+    results.begin(), results.end(),
+    [](Result<NLeaf> const& a, Result<NLeaf> const& b) {
+      return a.path < b.path;
+    });
+  results.erase(
+    unique(
+      results.begin(), results.end(),
+      [](Result<NLeaf> const& a, Result<NLeaf> const& b) {
+        return a.leaf == b.leaf;
+      }),
+    results.end());
+}
+
+/*! Calculate neighbours for every word in a trie.
+ *
+ * At most one segment has a budget (see the `Deduplicator` constructor), so
+ * the total distance is the only limit. The results of every search are
+ * sorted (see `sortResults()`), so every neighbour list is in lexicographic
+ * order, without repeats.
+ *
+ * \param trie Trie.
+ * \param segments Word segments.
+ *
+ * \return Number of unique words.
+ */
+template <class WordStore>
+size_t findEditNeighbours(
+    WordStore const& trie, Segments const& segments) {
+  size_t unique {0};
+
+  vector<Result<NLeaf>> results;
+  for (Result<NLeaf> const& walkResult: trie.walk()) {
+    results.clear();
+    for (Result<NLeaf> const& editResult: trie.asymmetricLevenshtein(
+        walkResult.path, fuzzyDistance(segments))) {
+      results.push_back(editResult);
+    }
+    sortResults(results);
+
+    for (Result<NLeaf> const& editResult: results) {
+      if (walkResult.leaf != editResult.leaf) {
+        walkResult.leaf->neighbours.push_back(editResult.leaf);
+        editResult.leaf->neighbours.push_back(walkResult.leaf);
+      }
+    }
+    unique++;
+  }
+
+  return unique;
+}
+
+/*! Calculate neighbours for every word in every partition.
+ *
+ * \param partitions Word stores.
+ * \param segments Word segments.
+ * \param edit Use the Levenshtein distance.
+ * \param maximum Use the maximum clustering method.
+ * \param threads Number of threads.
+ * \param log Log handle.
+ *
+ * \return Number of unique words.
+ */
+template <class WordStore>
+size_t findNeighbours(
+    vector<WordStore*> const& partitions, Segments const& segments,
+    bool const edit, bool const maximum, size_t const threads,
+    ofstream& log) {
+  time_t start {};
+  size_t unique {0};
+  if (edit) {
+    start = startMessage(
+      log, "Calculating neighbours using Levenshtein distance");
+    unique = parallelSum(partitions.size(), threads, [&](size_t const i) {
+      return findEditNeighbours(*partitions[i], segments);
+    });
+  }
+  else if (maximum) {
+    start = startMessage(log, "Calculating neighbours using Hamming distance");
+    unique = parallelSum(partitions.size(), threads, [&](size_t const i) {
+      return findHammingNeighbours(*partitions[i], segments);
+    });
+  }
+  else {
+    start = startMessage(
+      log, "Calculating directional neighbours using Hamming distance");
+    unique = parallelSum(partitions.size(), threads, [&](size_t const i) {
+      return findDirectionalNeighbours(*partitions[i], segments);
+    });
+  }
+  endMessage(log, start);
+
+  return unique;
+}
+
+/*! Group neighbours into clusters.
+ *
+ * \param trie Trie.
+ * \param maximum Use the maximum clustering method.
+ * \param clusters List of clusters, numbered from 1.
+ *
+ * \return Number of clusters.
+ */
+template <class WordStore>
+size_t findClusters(
+    WordStore& trie, bool const maximum, vector<Cluster*>& clusters) {
+  size_t id {1};
+  for (Result<NLeaf> const& result: trie.walk()) {
+    if (not result.leaf->cluster) {
+      Cluster* cluster {new Cluster {id++}};
+      if (maximum) {
+        assignMaxCluster(result.leaf, cluster);
+      }
+      else {
+        assignDirectionalCluster(result.leaf, cluster);
+      }
+      clusters.push_back(cluster);
+    }
+  }
+
+  return clusters.size();
+}
+
+/*! Group neighbours into clusters in every partition.
+ *
+ * \param partitions Word stores.
+ * \param maximum Use the maximum clustering method.
+ * \param threads Number of threads.
+ * \param log Log handle.
+ *
+ * \return List of clusters.
+ */
+template <class WordStore>
+vector<Cluster*> findClusters(
+    vector<WordStore*> const& partitions, bool const maximum,
+    size_t const threads, ofstream& log) {
+  time_t start{};
+  if (maximum) {
+    start = startMessage(log, "Calculating maximum clusters");
+  }
+  else {
+    start = startMessage(log, "Calculating directional clusters");
+  }
+
+  vector<vector<Cluster*>> partitionClusters(partitions.size());
+  parallelSum(partitions.size(), threads, [&](size_t const i) {
+    return findClusters(*partitions[i], maximum, partitionClusters[i]);
+  });
+
+  // Number the clusters of all partitions consecutively.
+  vector<Cluster*> clusters;
+  for (vector<Cluster*> const& partition: partitionClusters) {
+    for (Cluster* const cluster: partition) {
+      cluster->id = clusters.size() + 1;
+      clusters.push_back(cluster);
+    }
+  }
+  endMessage(log, start);
+
+  return clusters;
+}
+
+/*! Assign every read to a cluster.
+ *
+ * \param partitions Word stores.
+ * \param leafIds Leaf ID of every read, 0 for reads that were filtered.
+ * \param log Log handle.
+ *
+ * \return Cluster assignment of every read.
+ */
+template <class WordStore>
+ReadClusters assignReads(
+    vector<WordStore*> const& partitions, vector<uint32_t>&& leafIds,
+    ofstream& log) {
+  time_t start {startMessage(log, "Assigning reads to clusters")};
+
+  vector<uint32_t> leafClusters {0};
+  vector<bool> maxLeaves {false};
+  for (WordStore const* const trie: partitions) {
+    for (Result<NLeaf> const& result: trie->walk()) {
+      uint32_t const id {result.leaf->id};
+      if (id >= leafClusters.size()) {
+        leafClusters.resize(id + 1);
+        maxLeaves.resize(id + 1);
+      }
+      leafClusters[id] = result.leaf->cluster->id;
+      maxLeaves[id] = result.leaf->cluster->maxLeaf == result.leaf;
+    }
+  }
+
+  ReadClusters reads {
+    resolveReads(std::move(leafIds), leafClusters, maxLeaves)};
+  endMessage(log, start);
+
+  return reads;
+}
+
+/*! Make histograms of the number of perfect and nonperfect duplicates.
+ *
+ * \param partitions Word stores.
+ * \param log Log handle.
+ *
+ * \return Duplicate statistics histograms.
+ */
+template <class WordStore>
+tuple<map<size_t, size_t>, map<size_t, size_t>> runStatistics(
+    vector<WordStore*> const& partitions, ofstream& log) {
+  time_t start {startMessage(log, "Calculating count and neighbour stats")};
+
+  map<size_t, size_t> counts;
+  map<size_t, size_t> neighbours;
+  for (WordStore const* const trie: partitions) {
+    for (Result<NLeaf> const& result: trie->walk()) {
+      counts[result.leaf->count]++;
+      neighbours[result.leaf->neighbours.size()]++;
+    }
+  }
+  endMessage(log, start);
+
+  return tuple<map<size_t, size_t>, map<size_t, size_t>>(
+    counts, neighbours);
+}
+
+/*! Count the nodes of a trie, and estimate the memory of its nodes and
+ * leaves. The words are visited in lexicographic order, so every word adds
+ * one node for every letter after the longest common prefix with the
+ * previous word.
+ *
+ * The nodes and leaves are allocated one by one, so the estimate leaves out
+ * the allocator overhead.
+ *
+ * \param trie Trie.
+ * \param memory Memory usage, to which the nodes and bytes are added.
+ */
+template <class WordStore>
+void countTrie(WordStore const& trie, MemoryUsage& memory) {
+  using Node = remove_pointer_t<
+    decltype(declval<WordStore&>().add(declval<vector<uint8_t>&>()))>;
+
+  size_t nodes {1};
+  size_t leaves {0};
+  vector<uint8_t> previous;
+  for (Result<NLeaf> const& result: trie.walk()) {
+    size_t common {0};
+    while (
+        common < previous.size() and common < result.path.size() and
+        previous[common] == result.path[common]) {
+      common++;
+    }
+    nodes += result.path.size() - common;
+    leaves++;
+    previous = result.path;
+  }
+
+  memory.nodes.objects += nodes;
+  memory.nodes.bytes += nodes * sizeof(Node);
+  memory.leaves.bytes += leaves * sizeof(NLeaf);
+}
+
+/*! Count the nodes of a trie, and the memory allocated for its nodes and
+ * leaves.
+ *
+ * \param trie Trie.
+ * \param memory Memory usage, to which the nodes and bytes are added.
+ */
+template <class LeafType>
+void countTrie(RadixTrie<LeafType> const& trie, MemoryUsage& memory) {
+  memory.nodes.objects += trie.nodes();
+  memory.nodes.bytes += trie.nodeBytes();
+  memory.leaves.bytes += trie.leafBytes();
+}
+
+/*! \copydoc countTrie */
+template <class WordStore>
+void countTrie(ShardedTrie<WordStore> const& trie, MemoryUsage& memory) {
+  for (size_t i {0}; i < trie.shards(); i++) {
+    if (trie.store(i)) {
+      countTrie(*trie.store(i), memory);
+    }
+  }
+}
+
+/*! Count the nodes and leaves in every partition.
+ *
+ * \param partitions Word stores.
+ * \param leaves Number of leaves.
+ * \param memory Memory usage.
+ */
+template <class WordStore>
+void countWords(
+    vector<WordStore*> const& partitions, size_t const leaves,
+    MemoryUsage& memory) {
+  memory.nodes = {};
+  memory.leaves = {leaves, 0};
+  for (WordStore const* const trie: partitions) {
+    countTrie(*trie, memory);
+  }
+}
+
+/*! Count the neighbour list entries in every partition.
+ *
+ * \param partitions Word stores.
+ *
+ * \return Neighbour list usage.
+ */
+template <class WordStore>
+ObjectUsage countNeighbours(vector<WordStore*> const& partitions) {
+  ObjectUsage usage;
+  for (WordStore const* const trie: partitions) {
+    for (Result<NLeaf> const& result: trie->walk()) {
+      usage.objects += result.leaf->neighbours.size();
+      usage.bytes += result.leaf->neighbours.capacity() * sizeof(NLeaf*);
+    }
+  }
+
+  return usage;
+}
+
+/*! Find the neighbours of a word in a trie, in lexicographic order.
+ *
+ * \param trie Trie.
+ * \param word Word.
+ * \param segments Word segments.
+ * \param edit Use the Levenshtein distance.
+ *
+ * \return Neighbours, including the leaf of `word` itself.
+ */
+template <class WordStore>
+vector<NLeaf*> neighbourhood(
+    WordStore const& trie, vector<uint8_t> const& word,
+    Segments const& segments, bool const edit) {
+  vector<NLeaf*> leaves;
+  if (edit) {
+    vector<Result<NLeaf>> results;
+    for (Result<NLeaf> const& result: trie.levenshtein(
+        word, fuzzyDistance(segments))) {
+      results.push_back(result);
+    }
+    sortResults(results);
+    for (Result<NLeaf> const& result: results) {
+      leaves.push_back(result.leaf);
+    }
+  }
+  else {
+    for (Result<NLeaf> const& result: trie.hamming(
+        word, fuzzyDistance(segments))) {
+      if (withinBudgets(word, result.path, segments)) {
+        leaves.push_back(result.leaf);
+      }
+    }
+  }
+
+  return leaves;
+}
+
+/*! Recalculate the neighbour list of a leaf, in the order in which a full
+ * neighbour search would have made it.
+ *
+ * For the Hamming distance, this is lexicographic order, and the Levenshtein
+ * results are sorted into it (see `sortResults()`). For the directional
+ * method, the smaller leaves that dominate `leaf` come first,
+ * followed by the leaves dominated by `leaf` and the larger leaves that
+ * dominate `leaf`.
+ *
+ * \param trie Trie.
+ * \param result Walk result of the leaf.
+ * \param segments Word segments.
+ * \param edit Use the Levenshtein distance.
+ * \param maximum Use the maximum clustering method.
+ */
+template <class WordStore>
+void relink(
+    WordStore const& trie, Result<NLeaf> const& result,
+    Segments const& segments, bool const edit, bool const maximum) {
+  NLeaf* const leaf {result.leaf};
+  leaf->neighbours.clear();
+
+  if (edit or maximum) {
+    for (NLeaf* const neighbour: neighbourhood(
+        trie, result.path, segments, edit)) {
+      if (neighbour != leaf) {
+        leaf->neighbours.push_back(neighbour);
+      }
+    }
+    return;
+  }
+
+  vector<NLeaf*> dominated;
+  vector<NLeaf*> larger;
+  bool passed {false};
+  for (NLeaf* const neighbour: neighbourhood(
+      trie, result.path, segments, false)) {
+    if (neighbour == leaf) {
+      passed = true;
+    }
+    else if (dominates(neighbour, leaf)) {
+      if (passed) {
+        larger.push_back(neighbour);
+      }
+      else {
+        leaf->neighbours.push_back(neighbour);
+      }
+    }
+    else if (dominates(leaf, neighbour)) {
+      dominated.push_back(neighbour);
+    }
+  }
+  leaf->neighbours.insert(
+    leaf->neighbours.end(), dominated.begin(), dominated.end());
+  leaf->neighbours.insert(
+    leaf->neighbours.end(), larger.begin(), larger.end());
+}
+
+/*! Update the neighbours in a trie that was restored from a previous run.
+ * Only the neighbour lists of new words, of words with a changed count and of
+ * their neighbours are recalculated.
+ *
+ * \param trie Trie.
+ * \param segments Word segments.
+ * \param edit Use the Levenshtein distance.
+ * \param maximum Use the maximum clustering method.
+ * \param counts Counts of the words of the previous run, by leaf ID.
+ *
+ * \return Number of updated words.
+ */
+template <class WordStore>
+size_t updateNeighbours(
+    WordStore const& trie, Segments const& segments, bool const edit,
+    bool const maximum, vector<uint64_t> const& counts) {
+  unordered_set<NLeaf const*> affected;
+  for (Result<NLeaf> const& result: trie.walk()) {
+    uint32_t const id {result.leaf->id};
+    if (id > counts.size() or result.leaf->count != counts[id - 1]) {
+      for (NLeaf const* const neighbour: neighbourhood(
+          trie, result.path, segments, edit)) {
+        affected.insert(neighbour);
+      }
+    }
+  }
+
+  for (Result<NLeaf> const& result: trie.walk()) {
+    if (affected.contains(result.leaf)) {
+      relink(trie, result, segments, edit, maximum);
+    }
+  }
+
+  return affected.size();
+}
+
+/*! Update the neighbours in every partition.
+ *
+ * \param partitions Word stores.
+ * \param segments Word segments.
+ * \param edit Use the Levenshtein distance.
+ * \param maximum Use the maximum clustering method.
+ * \param threads Number of threads.
+ * \param counts Counts of the words of the previous run, by leaf ID.
+ * \param log Log handle.
+ */
+template <class WordStore>
+void updateNeighbours(
+    vector<WordStore*> const& partitions, Segments const& segments,
+    bool const edit, bool const maximum, size_t const threads,
+    vector<uint64_t> const& counts, ofstream& log) {
+  time_t start {startMessage(log, "Updating neighbours")};
+  size_t updated {parallelSum(partitions.size(), threads, [&](size_t const i) {
+    return updateNeighbours(*partitions[i], segments, edit, maximum, counts);
+  })};
+  endMessage(log, start);
+
+  log << "  updated: " << updated << " words\n";
+}
+
+/*! Word store, independent of the type of trie. */
+class Deduplicator::Store {
+public:
+  virtual ~Store() {}
+
+  /*! Add a word.
+   *
+   * \param word Word.
+   * \param segments Word segments.
+   *
+   * \return Leaf ID.
+   */
+  virtual uint32_t add(vector<uint8_t> const&, Segments const&) = 0;
+
+  /*! Add a batch of words.
+   *
+   * \param words Words.
+   * \param segments Word segments.
+   * \param threads Number of threads.
+   *
+   * \return Leaf ID of every word.
+   */
+  virtual vector<uint32_t> add(
+    vector<vector<uint8_t> const*> const&, Segments const&,
+    size_t const) = 0;
+
+  /*! Restore the words and neighbours of a previous run.
+   *
+   * \param input State file.
+   */
+  virtual void load(istream&) = 0;
+
+  /*! Find the clusters and release the words.
+   *
+   * \param leafIds Leaf ID of every record, 0 for records that were filtered.
+   * \param segments Word segments.
+   * \param edit Use the Levenshtein distance.
+   * \param maximum Use the maximum clustering method.
+   * \param threads Number of threads.
+   * \param runStats Calculate the statistics.
+   * \param stats Statistics.
+   * \param log Log handle.
+   * \param state Save the state to this file, if not null.
+   *
+   * \return Cluster assignment of every record.
+   */
+  virtual ReadClusters finalize(
+    vector<uint32_t>&&, Segments const&, bool const, bool const,
+    size_t const, bool const, DedupStats&, ofstream&, ostream* const) = 0;
+};
+
+
+/* Words stored in one trie for every distinct exact part. */
+template <class WordStore>
+class Partitions_ : public Deduplicator::Store {
+public:
+  /* \param prefix Number of letters used to shard the words. */
+  Partitions_(size_t const prefix) : prefix_ {prefix} {}
+
+  ~Partitions_() {
+    for (WordStore* const trie: partitions_) {
+      delete trie;
+    }
+  }
+
+  uint32_t add(
+      vector<uint8_t> const& word, Segments const& segments) override {
+    size_t const i {partition_(word, segments, fuzzy_)};
+    return id_(
+      partitions_[i]->add(partitioned(segments) ? fuzzy_ : word)->leaf);
+  }
+
+  vector<uint32_t> add(
+      vector<vector<uint8_t> const*> const& words, Segments const& segments,
+      size_t const threads) override {
+    // Route every word to the thread that owns its partition and shard, so
+    // every trie is only modified by one thread.
+    vector<size_t> partitions(words.size());
+    vector<vector<uint8_t>> fuzzy(partitioned(segments) ? words.size() : 0);
+    vector<vector<size_t>> routes(threads);
+    for (size_t i {0}; i < words.size(); i++) {
+      if (partitioned(segments)) {
+        partitions[i] = partition_(*words[i], segments, fuzzy[i]);
+        routes[partitions[i] % threads].push_back(i);
+      }
+      else {
+        partitions[i] = partition_(*words[i], segments, fuzzy_);
+        routes[partitions_[0]->shard(*words[i]) % threads].push_back(i);
+      }
+    }
+
+    vector<NLeaf*> leaves(words.size());
+    parallelSum(threads, threads, [&](size_t const t) {
+      for (size_t const i: routes[t]) {
+        leaves[i] = partitions_[partitions[i]]->add(
+          partitioned(segments) ? fuzzy[i] : *words[i])->leaf;
+      }
+      return size_t {0};
+    });
+
+    // Leaf IDs are handed out in the order of the words, as in a sequential
+    // build.
+    vector<uint32_t> ids(words.size());
+    for (size_t i {0}; i < words.size(); i++) {
+      ids[i] = id_(leaves[i]);
+    }
+    return ids;
+  }
+
+  void load(istream& input) override {
+    keys_.resize(readValue<uint64_t>(input));
+    for (string& key: keys_) {
+      key = readString(input);
+      index_[key] = partitions_.size();
+      partitions_.push_back(new WordStore(key.empty() ? prefix_ : 0));
+    }
+
+    vector<NLeaf*> leaves(readValue<uint64_t>(input));
+    vector<vector<uint32_t>> links(leaves.size());
+    for (size_t i {0}; i < leaves.size(); i++) {
+      uint32_t const partition {readValue<uint32_t>(input)};
+      vector<uint8_t> const path {readVector<uint8_t>(input)};
+      uint64_t const count {readValue<uint64_t>(input)};
+      links[i] = readVector<uint32_t>(input);
+
+      leaves[i] = partitions_.at(partition)->add(path)->leaf;
+      leaves[i]->count = count;
+      leaves[i]->id = ++leaves_;
+      counts_.push_back(count);
+    }
+
+    for (size_t i {0}; i < leaves.size(); i++) {
+      for (uint32_t const id: links[i]) {
+        leaves[i]->neighbours.push_back(leaves.at(id - 1));
+      }
+    }
+  }
+
+  ReadClusters finalize(
+      vector<uint32_t>&& leafIds, Segments const& segments, bool const edit,
+      bool const maximum, size_t const threads, bool const runStats,
+      DedupStats& stats, ofstream& log, ostream* const state) override {
+    if (partitioned(segments)) {
+      log << "  partitions: " << partitions_.size() << "\n";
+    }
+
+    MemoryUsage& memory {stats.memory};
+    countWords(partitions_, leaves_, memory);
+    memory.reads = {leafIds.size(), leafIds.capacity() * sizeof(uint32_t)};
+    memoryMessage(log, memory);
+
+    if (counts_.empty()) {
+      stats.unique = findNeighbours(
+        partitions_, segments, edit, maximum, threads, log);
+    }
+    else {
+      stats.unique = memory.leaves.objects;
+      updateNeighbours(
+        partitions_, segments, edit, maximum, threads, counts_, log);
+    }
+    memory.neighbours = countNeighbours(partitions_);
+
+    if (state) {
+      time_t start {startMessage(log, "Saving state")};
+      writeValue<uint64_t>(*state, stats.total);
+      writeValue<uint64_t>(*state, stats.usable);
+      writeValue<uint64_t>(*state, stats.lowComplexity);
+      writeVector(*state, leafIds);
+      save_(*state);
+      endMessage(log, start);
+    }
+    memoryMessage(log, memory);
+
+    vector<Cluster*> clusters {
+      findClusters(partitions_, maximum, threads, log)};
+    stats.clusters = clusters.size();
+    memory.clusters = {
+      clusters.size(),
+      clusters.size() * sizeof(Cluster) +
+        clusters.capacity() * sizeof(Cluster*)};
+    memoryMessage(log, memory);
+
+    if (runStats) {
+      tie(stats.counts, stats.neighbours) = runStatistics(partitions_, log);
+      stats.clusterSizes = clusterStats(clusters);
+    }
+
+    // Only the cluster assignment of every record is kept, so we can release
+    // the tries and the clusters.
+    ReadClusters reads {assignReads(partitions_, std::move(leafIds), log)};
+    for (WordStore* const trie: partitions_) {
+      delete trie;
+    }
+    partitions_.clear();
+    freeClusters(clusters);
+
+    // The words are released, so only the reads are left.
+    MemoryUsage current {};
+    current.reads = {
+      reads.ids.size(),
+      reads.ids.capacity() * sizeof(uint32_t) +
+        reads.representative.capacity() / 8};
+    memoryMessage(log, current);
+    memory.reads.bytes = max(memory.reads.bytes, current.reads.bytes);
+
+    return reads;
+  }
+
+private:
+  /* Find or make the partition of a word.
+   *
+   * \param word Word.
+   * \param segments Word segments.
+   * \param fuzzy Part of `word` used for the neighbour search, only set if
+   *   the words are partitioned.
+   *
+   * \return Partition index.
+   */
+  size_t partition_(
+      vector<uint8_t> const& word, Segments const& segments,
+      vector<uint8_t>& fuzzy) {
+    if (not partitioned(segments)) {
+      if (partitions_.empty()) {
+        partitions_.push_back(new WordStore(prefix_));
+        keys_.push_back({});
+      }
+      return 0;
+    }
+
+    splitWord(word, segments, key_, fuzzy);
+    auto [it, added] {index_.try_emplace(key_, partitions_.size())};
+    if (added) {
+      partitions_.push_back(new WordStore);
+      keys_.push_back(key_);
+    }
+    return it->second;
+  }
+
+  /* Get the leaf ID, handing out a new one for new leaves. */
+  uint32_t id_(NLeaf* const leaf) {
+    if (not leaf->id) {
+      leaf->id = ++leaves_;
+    }
+    return leaf->id;
+  }
+
+  /* Save the words and neighbours, in order of their leaf IDs. */
+  void save_(ostream& output) const {
+    writeValue<uint64_t>(output, keys_.size());
+    for (string const& key: keys_) {
+      writeString(output, key);
+    }
+
+    vector<uint32_t> partitions(leaves_);
+    vector<Result<NLeaf>> results(leaves_);
+    for (size_t i {0}; i < partitions_.size(); i++) {
+      for (Result<NLeaf> const& result: partitions_[i]->walk()) {
+        partitions[result.leaf->id - 1] = i;
+        results[result.leaf->id - 1] = result;
+      }
+    }
+
+    writeValue<uint64_t>(output, leaves_);
+    vector<uint32_t> links;
+    for (size_t i {0}; i < leaves_; i++) {
+      writeValue<uint32_t>(output, partitions[i]);
+      writeVector(output, results[i].path);
+      writeValue<uint64_t>(output, results[i].leaf->count);
+      links.clear();
+      for (NLeaf const* const neighbour: results[i].leaf->neighbours) {
+        links.push_back(neighbour->id);
+      }
+      writeVector(output, links);
+    }
+  }
+
+  size_t prefix_ {0};
+  vector<WordStore*> partitions_ {};
+  vector<string> keys_ {};
+  vector<uint64_t> counts_ {};  // Counts of the words of a previous run.
+  unordered_map<string, size_t> index_ {};
+  string key_ {};
+  vector<uint8_t> fuzzy_ {};
+  uint32_t leaves_ {0};
+};
+
+/* Choose the number of letters used to shard the words, such that there are
+ * enough shards to keep all threads busy. The Levenshtein search can not be
+ * divided over shards, and partitioned words are divided over their
+ * partitions instead.
+ */
+size_t shardPrefix_(
+    Segments const& segments, bool const edit, size_t const threads) {
+  if (edit or partitioned(segments) or threads <= 1) {
+    return 0;
+  }
+
+  size_t const length {accumulate(
+    segments.lengths.begin(), segments.lengths.end(), size_t {0})};
+  size_t prefix {0};
+  while (prefix + 1 < length and size_t {1} << (2 * prefix) < 4 * threads) {
+    prefix++;
+  }
+  return prefix;
+}
+
+
+Deduplicator::Deduplicator(
+    Segments const& segments, bool const edit, bool const maximum,
+    bool const radix, size_t const threads, size_t const complexity)
+    : segments_ {segments},
+      length_ {accumulate(
+        segments.lengths.begin(), segments.lengths.end(), size_t {0})},
+      edit_ {edit}, maximum_ {maximum}, threads_ {threads},
+      complexity_ {complexity} {
+  if (edit and fuzzySegments(segments) > 1) {
+    throw invalid_argument(
+      "the edit distance can not be combined with budgets per segment");
+  }
+
+  size_t const prefix {shardPrefix_(segments, edit, threads)};
+  if (radix) {
+    store_ = new Partitions_<ShardedTrie<RadixTrie<NLeaf>>>(prefix);
+  }
+  else {
+    store_ = new Partitions_<ShardedTrie<Trie<4, NLeaf>>>(prefix);
+  }
+}
+
+Deduplicator::~Deduplicator() {
+  delete store_;
+}
+
+/* Determine whether a word should be stored, and update the statistics. */
+bool Deduplicator::keep_(Word const& word) {
+  if (word.filtered) {
+    return false;
+  }
+
+  stats_.usable++;
+  // Low complexity words would form hubs with many neighbours, so they are
+  // kept out of the word store.
+  if (complexity_ and lowComplexity(word.data, complexity_)) {
+    stats_.lowComplexity++;
+    return false;
+  }
+  return true;
+}
+
+size_t Deduplicator::add(Word const& word) {
+  if (not store_) {
+    throw logic_error("records can not be added after finalisation");
+  }
+  if (word.data.size() != length_) {
+    throw invalid_argument("word length does not match the segments");
+  }
+
+  uint32_t id {0};
+  if (keep_(word)) {
+    id = store_->add(word.data, segments_);
+  }
+  leafIds_.push_back(id);
+
+  return stats_.total++;
+}
+
+size_t Deduplicator::add(vector<Word> const& words) {
+  if (not store_) {
+    throw logic_error("records can not be added after finalisation");
+  }
+
+  for (Word const& word: words) {
+    if (word.data.size() != length_) {
+      throw invalid_argument("word length does not match the segments");
+    }
+  }
+
+  vector<bool> keep(words.size());
+  vector<vector<uint8_t> const*> kept;
+  for (size_t i {0}; i < words.size(); i++) {
+    keep[i] = keep_(words[i]);
+    if (keep[i]) {
+      kept.push_back(&words[i].data);
+    }
+  }
+
+  vector<uint32_t> const ids {store_->add(kept, segments_, threads_)};
+  size_t next {0};
+  for (size_t i {0}; i < words.size(); i++) {
+    leafIds_.push_back(keep[i] ? ids[next++] : 0);
+  }
+
+  size_t const first {stats_.total};
+  stats_.total += words.size();
+  return first;
+}
+
+size_t Deduplicator::add(string_view const nucleotides) {
+  return add(makeWord(nucleotides));
+}
+
+void Deduplicator::load(istream& input) {
+  if (not store_ or stats_.total) {
+    throw logic_error("a state can only be loaded before adding records");
+  }
+
+  stats_.total = readValue<uint64_t>(input);
+  stats_.usable = readValue<uint64_t>(input);
+  stats_.lowComplexity = readValue<uint64_t>(input);
+  leafIds_ = readVector<uint32_t>(input);
+  store_->load(input);
+}
+
+void Deduplicator::finalize(
+    bool const runStats, ofstream& log, ostream* const state) {
+  if (not store_) {
+    throw logic_error("already finalised");
+  }
+
+  if (complexity_) {
+    log << "  low complexity: " << stats_.lowComplexity
+      << " reads set aside\n";
+  }
+
+  reads_ = store_->finalize(
+    std::move(leafIds_), segments_, edit_, maximum_, threads_, runStats,
+    stats_, log, state);
+  delete store_;
+  store_ = nullptr;
+}
+
+void Deduplicator::finalize(bool const runStats) {
+  ofstream log;
+  finalize(runStats, log);
+}
+
+uint32_t Deduplicator::cluster(size_t const record) const {
+  return reads_.ids[record];
+}
+
+bool Deduplicator::representative(size_t const record) const {
+  return reads_.representative[record];
+}
+
+ReadClusters const& Deduplicator::reads() const {
+  return reads_;
+}
+
+DedupStats const& Deduplicator::stats() const {
+  return stats_;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <fstream>
+#include <istream>
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include "cluster.h"
+#include "fastq.h"
+#include "memory.h"
+#include "segments.h"
+
+using std::map;
+using std::istream;
+using std::ofstream;
+using std::ostream;
+using std::string_view;
+using std::vector;
+
+/*! Statistics of a deduplication run. */
+struct DedupStats {
+  size_t total {0};     //!< Number of records.
+  size_t usable {0};    //!< Number of records that were not filtered.
+  size_t lowComplexity {0};  //!< Number of low complexity records.
+  size_t unique {0};    //!< Number of unique words.
+  size_t clusters {0};  //!< Number of clusters.
+  map<size_t, size_t> counts {};        //!< Perfect duplicate histogram.
+  map<size_t, size_t> neighbours {};    //!< Nonperfect duplicate histogram.
+  map<size_t, size_t> clusterSizes {};  //!< Cluster size histogram.
+  MemoryUsage memory {};                //!< Memory usage.
+};
+
+
+/*! Streaming deduplication.
+ *
+ * Words are added one record, or one batch of records, at a time. After
+ * `finalize()` is called, the cluster ID and representative status of every
+ * record can be queried, in the order in which the records were added.
+ */
+class Deduplicator {
+public:
+  /*! Constructor.
+   *
+   * \param segments Word segments, see `makeSegments()`.
+   * \param edit Use the Levenshtein distance. Only one segment can have a
+   *   budget, as an insertion or deletion moves letters across segments.
+   * \param maximum Use the maximum clustering method.
+   * \param radix Use a path-compressed trie to store the words.
+   * \param threads Number of threads.
+   * \param complexity Set records aside if a single nucleotide makes up more
+   *   than this percentage of their word, 0 to keep all records.
+   */
+  Deduplicator(
+    Segments const&, bool const = false, bool const = false,
+    bool const = false, size_t const = 1, size_t const = 0);
+  Deduplicator(Deduplicator const&) = delete;
+  ~Deduplicator();
+
+  Deduplicator& operator=(Deduplicator const&) = delete;
+
+  /*! Add a record.
+   *
+   * \param word Word of the record.
+   *
+   * \return Index of the record.
+   */
+  size_t add(Word const&);
+
+  /*! Add a record.
+   *
+   * \param nucleotides Nucleotides of the record.
+   *
+   * \return Index of the record.
+   */
+  size_t add(string_view const);
+
+  /*! Add a batch of records. With multiple threads, the words are divided
+   * over shards by their first letters, and the shards are filled
+   * concurrently.
+   *
+   * \param words Words of the records.
+   *
+   * \return Index of the first record.
+   */
+  size_t add(vector<Word> const&);
+
+  /*! Restore the words, neighbours and records of a previous run, saved by
+   * `finalize()`. This must be done before any records are added. Only the
+   * neighbours of new words and of words with a changed count are
+   * recalculated by `finalize()`.
+   *
+   * \param input State file.
+   */
+  void load(istream&);
+
+  /*! Find the clusters. The words are released afterwards.
+   *
+   * \param runStats Calculate the statistics.
+   * \param log Log handle.
+   * \param state Save the state to this file, if not null.
+   */
+  void finalize(bool const, ofstream&, ostream* const = nullptr);
+
+  /*! \copydoc finalize */
+  void finalize(bool const = false);
+
+  /*! Get the cluster of a record.
+   *
+   * \param record Index of the record.
+   *
+   * \return Cluster ID, 0 if the record was filtered or has a low
+   *   complexity.
+   */
+  uint32_t cluster(size_t const) const;
+
+  /*! Determine whether a record represents its cluster.
+   *
+   * \param record Index of the record.
+   *
+   * \return `true` if `record` is the representative of its cluster.
+   */
+  bool representative(size_t const) const;
+
+  /*! Get the cluster assignment of all records.
+   *
+   * \return Cluster assignment of every record.
+   */
+  ReadClusters const& reads() const;
+
+  /*! Get the statistics.
+   *
+   * \return Statistics.
+   */
+  DedupStats const& stats() const;
+
+  class Store;
+
+private:
+  bool keep_(Word const&);
+
+  Segments segments_ {};
+  size_t length_ {0};
+  bool edit_ {false};
+  bool maximum_ {false};
+  size_t threads_ {1};
+  size_t complexity_ {0};
+  Store* store_ {nullptr};
+  vector<uint32_t> leafIds_ {};
+  ReadClusters reads_ {};
+  DedupStats stats_ {};
+};
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <cmath>
+
+#include "estimate.h"
+
+using std::exp;
+using std::log;
+using std::max;
+using std::pow;
+using std::sqrt;
+
+
+/* Find the number of classes of a given size. */
+double frequency_(map<size_t, size_t> const& sizes, size_t const size) {
+  map<size_t, size_t>::const_iterator it {sizes.find(size)};
+  if (it == sizes.end()) {
+    return 0;
+  }
+  return it->second;
+}
+
+/* Extrapolate the number of observed classes. */
+double extrapolate_(
+    double const observed, double const unseen, double const f1,
+    double const n, double const m) {
+  if (not unseen or not f1) {
+    return observed;
+  }
+  return observed + unseen * (1 - pow(1 - f1 / (n * unseen + f1), m));
+}
+
+
+Estimate extrapolate(
+    map<size_t, size_t> const& sizes, size_t const sampled,
+    size_t const total) {
+  double observed {0};
+  for (auto const& [size, count]: sizes) {
+    observed += count;
+  }
+  if (sampled < 2 or total <= sampled) {
+    return {observed, observed, observed};
+  }
+
+  double const n {static_cast<double>(sampled)};
+  double const m {static_cast<double>(total - sampled)};
+  double const f1 {frequency_(sizes, 1)};
+  double const f2 {frequency_(sizes, 2)};
+  double const a {(n - 1) / n};
+
+  // Number of unseen classes and its variance.
+  double unseen {};
+  double variance {};
+  if (f2) {
+    double const r {f1 / f2};
+    unseen = a * f1 * r / 2;
+    variance = f2 * (
+      a * r * r / 2 + a * a * r * r * r + a * a * r * r * r * r / 4);
+  }
+  else {
+    unseen = a * f1 * (f1 - 1) / 2;
+    variance =
+      a * f1 * (f1 - 1) / 2 + a * a * f1 * pow(2 * f1 - 1, 2) / 4 -
+      a * a * pow(f1, 4) / (4 * (observed + unseen));
+  }
+
+  if (not unseen) {
+    return {observed, observed, observed};
+  }
+  double const c {
+    exp(1.96 * sqrt(log(1 + max(variance, 0.0) / (unseen * unseen))))};
+
+  return {
+    extrapolate_(observed, unseen, f1, n, m),
+    extrapolate_(observed, unseen / c, f1, n, m),
+    extrapolate_(observed, unseen * c, f1, n, m)};
+}
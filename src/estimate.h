@@ -0,0 +1,26 @@
+#pragma once
+
+#include <map>
+
+using std::map;
+
+/*! Estimate with a confidence interval. */
+struct Estimate {
+  double value {0};
+  double lower {0};
+  double upper {0};
+};
+
+
+/*! Estimate the number of distinct classes (clusters or unique words) that
+ * would be observed in a larger sample, using the Chao1 estimator for the
+ * number of unseen classes and the extrapolation of Chao et al. (2014). The
+ * confidence interval is based on the log-normal interval of Chao (1987).
+ *
+ * \param sizes Histogram of class sizes in the sample.
+ * \param sampled Number of items in the sample.
+ * \param total Number of items to extrapolate to.
+ *
+ * \return Estimated number of classes, with a 95% confidence interval.
+ */
+Estimate extrapolate(map<size_t, size_t> const&, size_t const, size_t const);
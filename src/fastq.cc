@@ -1,49 +1,63 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <iostream>
-#include <map>
+#include <numeric>
 #include <sstream>
 
 #include "fastq.h"
+#include "whitelist.h"
 #include "../lib/fastp/src/util.h"
 
+using std::accumulate;
+using std::array;
+using std::copy_n;
 using std::cout;
+using std::fill_n;
 using std::ios;
-using std::map;
+using std::max_element;
+using std::min;
+using std::to_chars;
 
-map<char const, uint8_t const> nuc {{'A', 0}, {'C', 1}, {'G', 2}, {'T', 3}};
-
-/* Read vector. */
-struct ReadVector_ {
-  void free() const;
-
-  vector<Read*> reads {};
-  bool eof {false};
-};
+/* Encoding of every character, 4 for anything other than `A`, `C`, `G` or
+ * `T`.
+ */
+constexpr array<uint8_t, 256> makeEncoding_() {
+  array<uint8_t, 256> encoding {};
+  encoding.fill(4);
+  encoding['A'] = 0;
+  encoding['C'] = 1;
+  encoding['G'] = 2;
+  encoding['T'] = 3;
+  return encoding;
+}
 
+constexpr array<uint8_t, 256> encoding_ {makeEncoding_()};
 
-/* Destroy a ReadVector. */
-void ReadVector_::free() const {
-  for (Read* const read: reads) {
+/* Destroy the reads of one record of every file. */
+void free_(vector<Read*>& reads) {
+  for (Read*& read: reads) {
     delete read;
+    read = nullptr;
   }
 }
 
-
-/* Read one FastQ record from multiple files.
+/* Read one record of every file.
  *
- * \param readers FastQ readers.
+ * \param readers Readers.
+ * \param reads Reads.
  *
- * \return FastQ records plus EOF status.
+ * \return `false` if any of the files has ended.
  */
-ReadVector_ readFastq_(vector<FastqReader*> const& readers) {
-  ReadVector_ readVector;
-  for (FastqReader* const reader: readers) {
-    Read* read {reader->read()};
-    if (not read) {
-      readVector.eof = true;
+bool readFastq_(vector<FastqReader*> const& readers, vector<Read*>& reads) {
+  bool complete {true};
+  for (size_t i {0}; i < readers.size(); i++) {
+    reads[i] = readers[i]->read();
+    if (not reads[i]) {
+      complete = false;
     }
-    readVector.reads.push_back(read);
   }
-  return readVector;
+  return complete;
 }
 
 /* Make string s the specified size, by either cutting it, or padding it.
@@ -69,14 +83,14 @@ string makeStringSize_(string s, size_t const size, char const padding) {
  *
  * \param header Fastq header line.
  */
-string extractUMI_(string const header) {
+string_view extractUMIView_(string_view const header) {
   size_t first_space {header.find(" ")};
 
   // The UMI must be before the first space.
-  string substr {header.substr(0, first_space)};
+  string_view substr {header.substr(0, first_space)};
 
   // If we detect a UMI with a _ separator, we return that UMI.
-  string umi {extractLastField(substr, '_')};
+  string_view umi {extractLastField(substr, '_')};
 
   // Check if the UMI only contains characters from 'ATCGN'. If we find any
   // other character, the 'UMI' is not actually a UMI.
@@ -92,72 +106,565 @@ string extractUMI_(string const header) {
   return "";
 }
 
+/* Extract a cell barcode from a header.
+ *
+ * \param header Fastq header line.
+ */
+string_view extractBarcodeView_(string_view const header) {
+  string_view substr {header.substr(0, header.find(" "))};
+
+  // The barcode is the field before the UMI, with the same separator.
+  for (char const separator: {'_', ':'}) {
+    string_view umi {extractLastField(substr, separator)};
+    if (validUMI(umi)) {
+      string_view barcode {extractLastField(
+        substr.substr(0, substr.size() - umi.size() - 1), separator)};
+      if (validUMI(barcode)) {
+        return barcode;
+      }
+      return "";
+    }
+  }
+  return "";
+}
+
+/* Extract UMI from a header.
+ *
+ * \param header Fastq header line.
+ */
+string extractUMI_(string const header) {
+  return string(extractUMIView_(header));
+}
+
+/* Access the header and sequence of reads of either type. */
+string_view name_(Read* const read) {
+  return *read->mName;
+}
+
+string_view name_(Record const& record) {
+  return record.name;
+}
+
+string_view sequence_(Read* const read) {
+  return *read->mSeq;
+}
+
+string_view sequence_(Record const& record) {
+  return record.sequence;
+}
+
+/* Add `s` to `nucleotides`, cut or padded to a given size.
+ *
+ * \param nucleotides Nucleotides.
+ * \param s String to add.
+ * \param size Number of characters to add.
+ * \param padding Character to use for padding.
+ */
+void addSized_(
+    vector<char>& nucleotides, string_view const s, size_t const size,
+    char const padding) {
+  size_t length {min(size, s.size())};
+  nucleotides.insert(nucleotides.end(), s.begin(), s.begin() + length);
+  nucleotides.insert(nucleotides.end(), size - length, padding);
+}
+
+/* Extract `wordLength` nucleotides from `reads`. */
+template <class T>
+vector<char> getNucleotides_(
+    vector<T> const& reads, vector<size_t> const& ntToTake,
+    size_t const headerUMISize) {
+  vector<char> nucleotides;
+
+  // Pull the UMI from the header of the first read, and cut/pad it to
+  // headerUMISize.
+  if (headerUMISize > 0) {
+    addSized_(
+      nucleotides, extractUMIView_(name_(reads.front())), headerUMISize, 'N');
+  }
+
+  // Add length nucleotides from every read, padded with N if it is too short.
+  for (size_t i {0}; i < reads.size(); i++) {
+    addSized_(nucleotides, sequence_(reads[i]), ntToTake[i], 'N');
+  }
+  return nucleotides;
+}
+
+/* Encode `size` nucleotides into `word`, reusing its memory. Words that
+ * contain anything other than `A`, `C`, `G` or `T` are filtered.
+ */
+void encodeInto_(
+    char const* const nucleotides, size_t const size, Word& word) {
+  word.data.resize(size);
+  word.filtered = false;
+  for (size_t i {0}; i < size; i++) {
+    uint8_t code {encoding_[static_cast<uint8_t>(nucleotides[i])]};
+    if (code > 3) {
+      code = encoding_['G'];
+      word.filtered = true;
+    }
+    word.data[i] = code;
+  }
+}
+
+/* Encode nucleotides as a word. */
+template <class T>
+Word encode_(T const& nucleotides) {
+  Word word;
+  encodeInto_(nucleotides.data(), nucleotides.size(), word);
+  return word;
+}
+
+/* Select a total of `wordLength` nucleotides from every read in `reads` to
+ * create a word.
+ */
+template <class T>
+Word makeWord_(
+    vector<T> const& reads, vector<size_t> const& ntToTake,
+    size_t const headerUMISize) {
+  return encode_(getNucleotides_(reads, ntToTake, headerUMISize));
+}
+
+/* Copy `s` to `destination`, cut or padded with `N` to a given size.
+ *
+ * \return `size`.
+ */
+size_t copySized_(
+    char* const destination, string_view const s, size_t const size) {
+  size_t length {min(size, s.size())};
+  copy_n(s.data(), length, destination);
+  fill_n(destination + length, size - length, 'N');
+  return size;
+}
+
+/* Make a word for any layout. */
+template <class T>
+void makeGenericWord_(
+    vector<T> const& reads, vector<size_t> const& ntToTake,
+    size_t const headerUMISize, Word& word) {
+  vector<char> nucleotides {getNucleotides_(reads, ntToTake, headerUMISize)};
+  encodeInto_(nucleotides.data(), nucleotides.size(), word);
+}
 
-generator<vector<Read*>> readFiles(vector<string> const files) {
+/* Make a word for a fixed number of files and word length. The nucleotides
+ * are gathered on the stack, and the loop over the files has a compile-time
+ * bound so it can be unrolled.
+ */
+template <size_t files, size_t length, class T>
+void makeFixedWord_(
+    vector<T> const& reads, vector<size_t> const& ntToTake,
+    size_t const headerUMISize, Word& word) {
+  array<char, length> nucleotides;
+  size_t position {0};
+  if (headerUMISize > 0) {
+    position = copySized_(
+      nucleotides.data(), extractUMIView_(name_(reads.front())),
+      headerUMISize);
+  }
+  for (size_t i {0}; i < files; i++) {
+    position += copySized_(
+      nucleotides.data() + position, sequence_(reads[i]), ntToTake[i]);
+  }
+  encodeInto_(nucleotides.data(), length, word);
+}
+
+/* Select a specialised implementation for a word length, if any. */
+template <class T, size_t length>
+void (*selectFiles_(size_t const files))(
+    vector<T> const&, vector<size_t> const&, size_t const, Word&) {
+  switch (files) {
+    case 1:
+      return makeFixedWord_<1, length, T>;
+    case 2:
+      return makeFixedWord_<2, length, T>;
+    case 3:
+      return makeFixedWord_<3, length, T>;
+  }
+  return nullptr;
+}
+
+/* Select a specialised implementation for a layout, if any. */
+template <class T>
+void (*selectLayout_(size_t const files, size_t const length))(
+    vector<T> const&, vector<size_t> const&, size_t const, Word&) {
+  switch (length) {
+    case 24:
+      return selectFiles_<T, 24>(files);
+    case 32:
+      return selectFiles_<T, 32>(files);
+  }
+  return nullptr;
+}
+
+/* Make a word from the UMI and template bases given by read structures. The
+ * nucleotides are gathered in the memory of `word` and encoded in place.
+ */
+template <class T>
+void makeStructuredWord_(
+    vector<T> const& reads, vector<ReadStructure> const& structures,
+    vector<size_t> const& ntToTake, size_t const umiSize, Word& word) {
+  size_t const length {
+    accumulate(ntToTake.begin(), ntToTake.end(), umiSize)};
+  word.data.resize(length);
+  char* const nucleotides {reinterpret_cast<char*>(word.data.data())};
+
+  // The UMI is cut to `umiSize` bases if the word is shorter than the UMI.
+  size_t position {0};
+  for (size_t i {0}; i < reads.size(); i++) {
+    position += structures[i].copyUMI(
+      sequence_(reads[i]), umiSize - position, nucleotides + position);
+  }
+  fill_n(nucleotides + position, umiSize - position, 'N');
+
+  // Add the template nucleotides, padded with N if the template is too short.
+  position = umiSize;
+  for (size_t i {0}; i < reads.size(); i++) {
+    size_t const copied {structures[i].copyTemplate(
+      sequence_(reads[i]), ntToTake[i], nucleotides + position)};
+    fill_n(nucleotides + position + copied, ntToTake[i] - copied, 'N');
+    position += ntToTake[i];
+  }
+  encodeInto_(nucleotides, length, word);
+}
+
+/* Make a word for every read in a block. The sequences of the next read are
+ * prefetched while the current word is made.
+ */
+template <class T, class F>
+void makeBlock_(
+    ReadBlock<T> const& block, F const make, vector<size_t> const& ntToTake,
+    size_t const headerUMISize, Word* const words) {
+  for (size_t i {0}; i < block.size; i++) {
+    if (i + 1 < block.size) {
+      for (T const& read: block.reads[i + 1]) {
+        __builtin_prefetch(sequence_(read).data());
+      }
+    }
+    make(block.reads[i], ntToTake, headerUMISize, words[i]);
+  }
+}
+
+/* Append `size` nucleotides of the cell barcode of `reads` to `word`. A
+ * barcode of another length makes the word filtered.
+ */
+template <class T>
+void appendBarcode_(vector<T> const& reads, size_t const size, Word& word) {
+  string_view const barcode {extractBarcodeView_(name_(reads.front()))};
+  if (barcode.size() != size) {
+    word.filtered = true;
+  }
+  for (size_t i {0}; i < size; i++) {
+    if (i < barcode.size()) {
+      word.data.push_back(encoding_[static_cast<uint8_t>(barcode[i])]);
+    }
+    else {
+      word.data.push_back(encoding_['G']);
+    }
+  }
+}
+
+/* Correct the UMI of a word and append the cell barcode, if needed. */
+template <class T>
+void finishWord_(
+    vector<T> const& reads, Whitelist const* const whitelist,
+    size_t const barcodeSize, Word& word) {
+  if (whitelist) {
+    whitelist->correct(word);
+  }
+  if (barcodeSize) {
+    appendBarcode_(reads, barcodeSize, word);
+  }
+}
+
+
+generator<ReadBlock<Read*>> readFiles(
+    vector<string> const files, size_t const size) {
   vector<FastqReader*> readers;
   for (string const& file: files) {
     FastqReader* reader {new FastqReader(file.c_str())};
     readers.push_back(reader);
   }
 
-  ReadVector_ readVector {readFastq_(readers)};
-  while (not readVector.eof) {
-    co_yield readVector.reads;
-    readVector.free();
-    readVector = readFastq_(readers);
+  ReadBlock<Read*> block {
+    vector<vector<Read*>>(size, vector<Read*>(readers.size())), 0};
+  bool eof {false};
+  while (not eof) {
+    block.size = 0;
+    while (block.size < size and not eof) {
+      if (readFastq_(readers, block.reads[block.size])) {
+        block.size++;
+      }
+      else {
+        // Files of unequal length leave an incomplete record.
+        free_(block.reads[block.size]);
+        eof = true;
+      }
+    }
+    if (block.size) {
+      co_yield block;
+    }
+    for (size_t i {0}; i < block.size; i++) {
+      free_(block.reads[i]);
+    }
   }
-  // TODO: Extra readVector.free() here when files are not of equal length?
 
   for (FastqReader* const reader: readers) {
     delete reader;
   }
 }
 
-vector<char> getNucleotides(
-    vector<Read*> const& reads, vector<size_t> const ntToTake,
-    size_t const headerUMISize) {
-  vector<char> nucleotides;
-
-  // Pull the UMI from the header of the first read.
-  if (headerUMISize > 0) {
-    // Get the UMI, and cut/pad it to headerUMISize.
-    string headerUMI {makeStringSize_(
-      extractUMI(reads.front()), headerUMISize, 'N')};
-    for (size_t i {0}; i < headerUMISize; i++) {
-      nucleotides.push_back(headerUMI[i]);
+generator<ReadBlock<Record>> readRecords(
+    vector<string> const files, size_t const threads, size_t const size) {
+  vector<RecordReader*> readers;
+  for (string const& file: files) {
+    if (blockCompressed(file)) {
+      readers.push_back(new BlockFastq(file.c_str(), threads));
+    }
+    else {
+      readers.push_back(new MappedFastq(file.c_str()));
     }
   }
 
-  for (size_t i {0}; i < reads.size(); i++) {
-    Read* read {reads[i]};
-    size_t length {ntToTake[i]};
+  ReadBlock<Record> block {
+    vector<vector<Record>>(size, vector<Record>(readers.size())), 0};
+  bool eof {false};
+  while (not eof) {
+    // The records of the previous block are no longer in use.
+    for (RecordReader* const reader: readers) {
+      reader->release();
+    }
 
-    // Padd the reads with N if it is too short.
-    string sequence {makeStringSize_(*read->mSeq, length, 'N')};
+    block.size = 0;
+    while (block.size < size and not eof) {
+      for (size_t i {0}; i < readers.size(); i++) {
+        if (not readers[i]->read(block.reads[block.size][i])) {
+          eof = true;
+        }
+      }
+      if (not eof) {
+        block.size++;
+      }
+    }
+    if (block.size) {
+      co_yield block;
+    }
+  }
+
+  for (RecordReader* const reader: readers) {
+    delete reader;
+  }
+}
 
-    // Add length nucleotides from Read.
-    for (size_t pos {0}; pos < length; pos++) {
-      nucleotides.push_back(sequence[pos]);
+bool recordFiles(vector<string> const files) {
+  for (string const& file: files) {
+    if (not mappable(file) and not blockCompressed(file)) {
+      return false;
     }
   }
-  return nucleotides;
+  return true;
+}
+
+vector<char> getNucleotides(
+    vector<Read*> const& reads, vector<size_t> const ntToTake,
+    size_t const headerUMISize) {
+  return getNucleotides_(reads, ntToTake, headerUMISize);
+}
+
+vector<char> getNucleotides(
+    vector<Record> const& reads, vector<size_t> const ntToTake,
+    size_t const headerUMISize) {
+  return getNucleotides_(reads, ntToTake, headerUMISize);
 }
 
 Word makeWord(
     vector<Read*> const& reads, vector<size_t> const ntToTake,
     size_t const headerUMISize) {
-  Word word;
-  vector<char> nucleotides {getNucleotides(reads, ntToTake, headerUMISize)};
-  for (char const& nucleotide: nucleotides) {
-    if (nuc.contains(nucleotide)) {
-      word.data.push_back(nuc[nucleotide]);
+  return makeWord_(reads, ntToTake, headerUMISize);
+}
+
+Word makeWord(
+    vector<Record> const& reads, vector<size_t> const ntToTake,
+    size_t const headerUMISize) {
+  return makeWord_(reads, ntToTake, headerUMISize);
+}
+
+WordMaker::WordMaker(
+    vector<size_t> const& ntToTake, size_t const headerUMISize,
+    Whitelist const* const whitelist, size_t const barcodeSize,
+    vector<ReadStructure> const& structures)
+    : ntToTake_ {ntToTake}, headerUMISize_ {headerUMISize},
+      whitelist_ {whitelist}, barcodeSize_ {barcodeSize},
+      structures_ {structures} {
+  size_t const length {
+    accumulate(ntToTake.begin(), ntToTake.end(), headerUMISize)};
+  if (structures_.empty()) {
+    fromReads_ = selectLayout_<Read*>(ntToTake.size(), length);
+    fromRecords_ = selectLayout_<Record>(ntToTake.size(), length);
+  }
+  specialised_ = fromReads_ != nullptr;
+  if (not specialised_) {
+    fromReads_ = makeGenericWord_<Read*>;
+    fromRecords_ = makeGenericWord_<Record>;
+  }
+}
+
+void WordMaker::make(vector<Read*> const& reads, Word& word) const {
+  if (structures_.empty()) {
+    fromReads_(reads, ntToTake_, headerUMISize_, word);
+  }
+  else {
+    makeStructuredWord_(
+      reads, structures_, ntToTake_, headerUMISize_, word);
+  }
+  finishWord_(reads, whitelist_, barcodeSize_, word);
+}
+
+void WordMaker::make(vector<Record> const& reads, Word& word) const {
+  if (structures_.empty()) {
+    fromRecords_(reads, ntToTake_, headerUMISize_, word);
+  }
+  else {
+    makeStructuredWord_(
+      reads, structures_, ntToTake_, headerUMISize_, word);
+  }
+  finishWord_(reads, whitelist_, barcodeSize_, word);
+}
+
+void WordMaker::make(
+    ReadBlock<Read*> const& block, Word* const words) const {
+  if (structures_.empty()) {
+    makeBlock_(block, fromReads_, ntToTake_, headerUMISize_, words);
+  }
+  else {
+    makeBlock_(
+      block, [this](
+          vector<Read*> const& reads, vector<size_t> const& ntToTake,
+          size_t const umiSize, Word& word) {
+        makeStructuredWord_(reads, structures_, ntToTake, umiSize, word);
+      },
+      ntToTake_, headerUMISize_, words);
+  }
+  if (whitelist_ or barcodeSize_) {
+    for (size_t i {0}; i < block.size; i++) {
+      finishWord_(block.reads[i], whitelist_, barcodeSize_, words[i]);
     }
-    else {
-      word.data.push_back(nuc['G']);
-      word.filtered = true;
+  }
+}
+
+void WordMaker::make(
+    ReadBlock<Record> const& block, Word* const words) const {
+  if (structures_.empty()) {
+    makeBlock_(block, fromRecords_, ntToTake_, headerUMISize_, words);
+  }
+  else {
+    makeBlock_(
+      block, [this](
+          vector<Record> const& reads, vector<size_t> const& ntToTake,
+          size_t const umiSize, Word& word) {
+        makeStructuredWord_(reads, structures_, ntToTake, umiSize, word);
+      },
+      ntToTake_, headerUMISize_, words);
+  }
+  if (whitelist_ or barcodeSize_) {
+    for (size_t i {0}; i < block.size; i++) {
+      finishWord_(block.reads[i], whitelist_, barcodeSize_, words[i]);
     }
   }
-  return word;
+}
+
+bool WordMaker::specialised() const {
+  return specialised_;
+}
+
+Word makeWord(string_view const nucleotides) {
+  return encode_(nucleotides);
+}
+
+bool lowComplexity(vector<uint8_t> const& word, size_t const percentage) {
+  size_t counts[4] {};
+  for (uint8_t const letter: word) {
+    counts[letter]++;
+  }
+  return *max_element(counts, counts + 4) * 100 > percentage * word.size();
+}
+
+/* Write a cluster ID suffix for a read header. */
+void writeSuffix_(OutputFile* const output, size_t const id) {
+  char suffix[24] {':'};
+  char* end {to_chars(suffix + 1, suffix + sizeof suffix, id).ptr};
+  output->write({suffix, static_cast<size_t>(end - suffix)});
+}
+
+/* Write the part of a read after the header. */
+void writeBody_(OutputFile* const output, Read* const read) {
+  output->put('\n');
+  output->write(*read->mSeq);
+  output->put('\n');
+  output->write(*read->mStrand);
+  output->put('\n');
+  output->write(*read->mQuality);
+  output->put('\n');
+}
+
+
+void writeRead(OutputFile* const output, Read* const read) {
+  output->write(*read->mName);
+  writeBody_(output, read);
+}
+
+void writeRead(OutputFile* const output, Record const& record) {
+  output->write(record.text);
+  if (not record.text.ends_with('\n')) {
+    output->put('\n');
+  }
+}
+
+void writeAnnotatedRead(
+    OutputFile* const output, Read* const read, size_t const id) {
+  output->write(*read->mName);
+  writeSuffix_(output, id);
+  writeBody_(output, read);
+}
+
+void writeAnnotatedRead(
+    OutputFile* const output, Record const& record, size_t const id) {
+  size_t offset {record.name.size()};
+
+  output->write(record.text.substr(0, offset));
+  writeSuffix_(output, id);
+  output->write(record.text.substr(offset));
+  if (not record.text.ends_with('\n')) {
+    output->put('\n');
+  }
+}
+
+void appendAnnotatedRead(
+    string& text, Read* const read, size_t const id) {
+  char suffix[24] {':'};
+  char* end {to_chars(suffix + 1, suffix + sizeof suffix, id).ptr};
+
+  text += *read->mName;
+  text.append(suffix, end);
+  text += '\n';
+  text += *read->mSeq;
+  text += '\n';
+  text += *read->mStrand;
+  text += '\n';
+  text += *read->mQuality;
+  text += '\n';
+}
+
+void appendAnnotatedRead(
+    string& text, Record const& record, size_t const id) {
+  size_t offset {record.name.size()};
+  char suffix[24] {':'};
+  char* end {to_chars(suffix + 1, suffix + sizeof suffix, id).ptr};
+
+  text += record.text.substr(0, offset);
+  text.append(suffix, end);
+  text += record.text.substr(offset);
+  if (not record.text.ends_with('\n')) {
+    text += '\n';
+  }
 }
 
 void printWord(vector<uint8_t> const& word) {
@@ -189,7 +696,7 @@ vector<string> makeFileNames(
   return fileNames;
 }
 
-string extractLastField(string const str, char const sep) {
+string_view extractLastField(string_view const str, char const sep) {
   size_t last {str.find_last_of(sep)};
 
   if (last != string::npos) {
@@ -198,7 +705,7 @@ string extractLastField(string const str, char const sep) {
   return "";
 }
 
-bool validUMI(string const umi) {
+bool validUMI(string_view const umi) {
   // An empty UMI is not valid.
   if (umi.empty()) {
     return false;
@@ -206,7 +713,7 @@ bool validUMI(string const umi) {
 
   // Only ATCG is valid in a UMI.
   for (char const c: umi) {
-    if (nuc.find(c) == nuc.end()) {
+    if (encoding_[static_cast<uint8_t>(c)] > 3) {
       return false;
     }
   }
@@ -217,6 +724,18 @@ string extractUMI(Read* const read) {
   return extractUMI_(*read->mName);
 }
 
+string_view extractUMI(Record const& record) {
+  return extractUMIView_(record.name);
+}
+
+string extractBarcode(Read* const read) {
+  return string(extractBarcodeView_(*read->mName));
+}
+
+string_view extractBarcode(Record const& record) {
+  return extractBarcodeView_(record.name);
+}
+
 vector<size_t> ntFromFile(size_t const files, size_t const length) {
   vector<size_t> v{};
   size_t div {length / files};
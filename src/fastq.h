@@ -1,12 +1,19 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../lib/trie/lib/CPP20Coroutines/include/generator.hpp"
 #include "../lib/fastp/src/fastqreader.h"
 
+#include "bgzf.h"
+#include "mapped.h"
+#include "output.h"
+#include "structure.h"
+
 using std::string;
+using std::string_view;
 using std::vector;
 
 /*! Word. */
@@ -15,14 +22,51 @@ struct Word {
   bool filtered {false};
 };
 
+/*! Block of consecutive reads from multiple files. The same block is reused
+ * for every step of a loop, so its memory is only allocated once.
+ */
+template <class T>
+struct ReadBlock {
+  vector<vector<T>> reads {};  //!< Record of every file, per read.
+  size_t size {0};             //!< Number of reads in the block.
+};
+
+class Whitelist;
+
+size_t const readBlockSize {1 << 12};
+
+
+/*! Loop over all reads in multiple FastQ files, one block at a time.
+ *
+ * \param files FastQ file names.
+ * \param size Maximum number of reads per block.
+ *
+ * \return Blocks of reads, only the last one can be partially filled. A
+ *   block is valid until the next one is read.
+ */
+generator<ReadBlock<Read*>> readFiles(
+  vector<string> const, size_t const = readBlockSize);
+
+/*! Loop over all records in multiple uncompressed or BGZF compressed FastQ
+ * files, one block at a time, without allocating a read per record.
+ *
+ * \param files FastQ file names.
+ * \param threads Number of decompression threads per file.
+ * \param size Maximum number of reads per block.
+ *
+ * \return Blocks of records, only the last one can be partially filled. A
+ *   block is valid until the next one is read.
+ */
+generator<ReadBlock<Record>> readRecords(
+  vector<string> const, size_t const, size_t const = readBlockSize);
 
-/*! Loop over all reads in multiple FastQ files.
+/*! Determine whether all files can be read with `readRecords`.
  *
  * \param files FastQ file names.
  *
- * \return All reads.
+ * \return `true` if all files are uncompressed or BGZF compressed.
  */
-generator<vector<Read*>> readFiles(vector<string> const);
+bool recordFiles(vector<string> const);
 
 /*! Extract `wordLength` nucleotides from `reads`. If the first file has a UMI
  * in the header, this will get preference.
@@ -30,6 +74,10 @@ generator<vector<Read*>> readFiles(vector<string> const);
 vector<char> getNucleotides(
   vector<Read*> const&, vector<size_t> const, size_t const);
 
+/*! \copydoc getNucleotides */
+vector<char> getNucleotides(
+  vector<Record> const&, vector<size_t> const, size_t const);
+
 /*! Select a total of `wordLength` nucleotides from every read in `reads` to
  * create a word.
  *
@@ -40,6 +88,124 @@ vector<char> getNucleotides(
  */
 Word makeWord(vector<Read*> const&, vector<size_t> const, size_t const);
 
+/*! \copydoc makeWord */
+Word makeWord(vector<Record> const&, vector<size_t> const, size_t const);
+
+/*! Word extraction, specialised at startup for the most common layouts: one
+ * to three files with a word length of 24 or 32. Other layouts use the
+ * generic implementation of `makeWord`. If a whitelist is given, the UMI at
+ * the start of every word is corrected. If a barcode size is given, the cell
+ * barcode in the header is appended to every word. If read structures are
+ * given, the UMI is taken from the reads instead of from the header, and the
+ * remainder of the word from the template bases.
+ */
+class WordMaker {
+public:
+  /*! Constructor.
+   *
+   * \param ntToTake Nucleotides to take from each file.
+   * \param headerUMISize Nucleotides to take from the UMI header, or from the
+   *   in-read UMIs if read structures are given.
+   * \param whitelist UMI whitelist, if any.
+   * \param barcodeSize Nucleotides to take from the cell barcode.
+   * \param structures Read structure of every file, if any.
+   */
+  WordMaker(
+    vector<size_t> const&, size_t const, Whitelist const* const = nullptr,
+    size_t const = 0, vector<ReadStructure> const& = {});
+
+  /*! Select nucleotides from every read in `reads` to create a word, like
+   * `makeWord`. The memory of `word` is reused.
+   *
+   * \param reads Reads.
+   * \param word Word.
+   */
+  void make(vector<Read*> const&, Word&) const;
+
+  /*! \copydoc make */
+  void make(vector<Record> const&, Word&) const;
+
+  /*! Create a word for every read in `block`. The memory of `words` is
+   * reused.
+   *
+   * \param block Block of reads.
+   * \param words Words, at least `block.size` of them.
+   */
+  void make(ReadBlock<Read*> const&, Word* const) const;
+
+  /*! \copydoc make(ReadBlock<Read*> const&, Word* const) const */
+  void make(ReadBlock<Record> const&, Word* const) const;
+
+  /*! Determine whether a specialised implementation is used.
+   *
+   * \return `true` if the layout has a specialised implementation.
+   */
+  bool specialised() const;
+
+private:
+  vector<size_t> ntToTake_ {};
+  size_t headerUMISize_ {0};
+  Whitelist const* whitelist_ {nullptr};
+  size_t barcodeSize_ {0};
+  vector<ReadStructure> structures_ {};
+  bool specialised_ {false};
+  void (*fromReads_)(
+    vector<Read*> const&, vector<size_t> const&, size_t const, Word&) {};
+  void (*fromRecords_)(
+    vector<Record> const&, vector<size_t> const&, size_t const, Word&) {};
+};
+
+/*! Make a word from a string of nucleotides. Words that contain anything
+ * other than `A`, `C`, `G` or `T` are filtered.
+ *
+ * \param nucleotides Nucleotides.
+ *
+ * \return Word.
+ */
+Word makeWord(string_view const);
+
+/*! Determine whether a word has a low complexity, i.e., whether a single
+ * nucleotide makes up more than a given percentage of it.
+ *
+ * \param word Word.
+ * \param percentage Maximum percentage of a single nucleotide.
+ *
+ * \return `true` if `word` has a low complexity.
+ */
+bool lowComplexity(vector<uint8_t> const&, size_t const);
+
+/*! Write a read.
+ *
+ * \param writer Output file.
+ * \param read Read.
+ */
+void writeRead(OutputFile* const, Read* const);
+
+/*! \copydoc writeRead */
+void writeRead(OutputFile* const, Record const&);
+
+/*! Write a read, with a cluster ID appended to the header.
+ *
+ * \param writer Output file.
+ * \param read Read.
+ * \param id Cluster ID.
+ */
+void writeAnnotatedRead(OutputFile* const, Read* const, size_t const);
+
+/*! \copydoc writeAnnotatedRead */
+void writeAnnotatedRead(OutputFile* const, Record const&, size_t const);
+
+/*! Append a read, with a cluster ID appended to the header, to a string.
+ *
+ * \param text String.
+ * \param read Read.
+ * \param id Cluster ID.
+ */
+void appendAnnotatedRead(string&, Read* const, size_t const);
+
+/*! \copydoc appendAnnotatedRead */
+void appendAnnotatedRead(string&, Record const&, size_t const);
+
 /*! Print a word.
  *
  * \param word Word.
@@ -63,14 +229,14 @@ vector<string> makeFileNames(vector<string> const, string const, string const);
  * \param str String to extract field from.
  * \param sep Separator between the fields.
  */
-string extractLastField(string const, char const);
+string_view extractLastField(string_view const, char const);
 
 /*! Determine of UMI is a valid UMI. It must be non-emtpy and only contain
  * characters from ATCG.
  *
  * \param umi The UMI to check.
  */
-bool validUMI(string const);
+bool validUMI(string_view const);
 
 /*! Extract UMI from a read.
  *
@@ -78,6 +244,21 @@ bool validUMI(string const);
  */
 string extractUMI(Read* const);
 
+/*! \copydoc extractUMI */
+string_view extractUMI(Record const&);
+
+/*! Extract a cell barcode from a read, i.e., the header field before the
+ * UMI, separated in the same way.
+ *
+ * \param read Read.
+ *
+ * \return Barcode, empty if the header has no valid barcode.
+ */
+string extractBarcode(Read* const);
+
+/*! \copydoc extractBarcode */
+string_view extractBarcode(Record const&);
+
 /*! Divide `length` nucleotides over `files`, with the remainder used on the
  * last file.
  *
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+
+#include "grouped.h"
+#include "state.h"
+
+using std::filesystem::remove;
+using std::ifstream;
+using std::ios;
+using std::min;
+using std::ofstream;
+using std::priority_queue;
+using std::runtime_error;
+using std::sort;
+using std::to_string;
+
+
+/* Determine whether `a` is written before `b`.
+ *
+ * \param a Read.
+ * \param b Read.
+ *
+ * \return `true` if `a` is written before `b`.
+ */
+bool before_(GroupedRead const& a, GroupedRead const& b) {
+  // Cluster 0 wraps around to the largest value.
+  uint32_t const x {a.cluster - 1};
+  uint32_t const y {b.cluster - 1};
+  if (x != y) {
+    return x < y;
+  }
+  if (a.representative != b.representative) {
+    return a.representative;
+  }
+  return a.ordinal < b.ordinal;
+}
+
+/* Write a read to a run file.
+ *
+ * \param output Run file.
+ * \param read Read.
+ */
+void writeRun_(ofstream& output, GroupedRead const& read) {
+  writeValue(output, read.cluster);
+  writeValue<uint8_t>(output, read.representative);
+  writeValue(output, read.ordinal);
+  writeValue<uint32_t>(output, read.reads.size());
+  for (string const& record: read.reads) {
+    writeValue<uint32_t>(output, record.size());
+    output.write(record.data(), record.size());
+  }
+}
+
+/* Read the next read from a run file.
+ *
+ * \param input Run file.
+ * \param read Read.
+ *
+ * \return `true` if a read was read, `false` at the end of the file.
+ */
+bool readRun_(ifstream& input, GroupedRead& read) {
+  if (input.peek() == ifstream::traits_type::eof()) {
+    return false;
+  }
+  read.cluster = readValue<uint32_t>(input);
+  read.representative = readValue<uint8_t>(input);
+  read.ordinal = readValue<uint64_t>(input);
+  read.reads.resize(readValue<uint32_t>(input));
+  for (string& record: read.reads) {
+    record.resize(readValue<uint32_t>(input));
+    if (not input.read(record.data(), record.size())) {
+      throw runtime_error("truncated run file");
+    }
+  }
+  return true;
+}
+
+/* Merge sorted run files.
+ *
+ * \param names Run file names.
+ * \param f Function that is called for every read, in sorted order.
+ */
+template <class F>
+void merge_(vector<string> const& names, F const& f) {
+  vector<ifstream> inputs;
+  vector<GroupedRead> heads(names.size());
+
+  auto const later {[&heads](size_t const a, size_t const b) {
+    return before_(heads[b], heads[a]);
+  }};
+  priority_queue<size_t, vector<size_t>, decltype(later)> queue {later};
+
+  for (size_t i {0}; i < names.size(); i++) {
+    inputs.emplace_back(names[i], ios::in | ios::binary);
+    if (not inputs[i]) {
+      throw runtime_error("unable to open run file " + names[i]);
+    }
+    if (readRun_(inputs[i], heads[i])) {
+      queue.push(i);
+    }
+  }
+
+  while (not queue.empty()) {
+    size_t const i {queue.top()};
+    queue.pop();
+    f(heads[i]);
+    if (readRun_(inputs[i], heads[i])) {
+      queue.push(i);
+    }
+  }
+}
+
+/* Write a read to the output files.
+ *
+ * \param outFiles Output files.
+ * \param read Read.
+ */
+void writeOutput_(
+    vector<OutputFile*> const& outFiles, GroupedRead const& read) {
+  for (size_t i {0}; i < outFiles.size(); i++) {
+    outFiles[i]->write(read.reads[i]);
+  }
+}
+
+
+ClusterSorter::ClusterSorter(
+    string const dirName, size_t const memory, size_t const fanIn)
+    : dirName_ {dirName}, memory_ {memory}, fanIn_ {fanIn} {
+  if (fanIn_ < 2) {
+    throw runtime_error("a merge needs at least two runs");
+  }
+}
+
+ClusterSorter::~ClusterSorter() {
+  removeRuns_();
+}
+
+void ClusterSorter::add(
+    uint32_t const cluster, bool const representative,
+    vector<string>&& reads) {
+  size_t size {sizeof(GroupedRead)};
+  for (string const& record: reads) {
+    size += sizeof(string) + record.capacity();
+  }
+
+  buffer_.push_back({cluster, representative, ordinal_++, std::move(reads)});
+  size_ += size;
+  if (size_ >= memory_) {
+    spill_();
+  }
+}
+
+void ClusterSorter::write(vector<OutputFile*> const& outFiles) {
+  // Everything fits in memory.
+  if (runs_.empty()) {
+    sort(buffer_.begin(), buffer_.end(), before_);
+    for (GroupedRead const& read: buffer_) {
+      writeOutput_(outFiles, read);
+    }
+    buffer_.clear();
+    size_ = 0;
+    return;
+  }
+
+  spill_();
+  while (runs_.size() > fanIn_) {
+    vector<string> merged;
+    for (size_t i {0}; i < runs_.size(); i += fanIn_) {
+      vector<string> const group(
+        runs_.begin() + i, runs_.begin() + min(i + fanIn_, runs_.size()));
+      if (group.size() == 1) {
+        merged.push_back(group.front());
+        continue;
+      }
+
+      string const name {runName_()};
+      ofstream output(name, ios::out | ios::binary);
+      merge_(group, [&output](GroupedRead const& read) {
+        writeRun_(output, read);
+      });
+      output.close();
+      merged.push_back(name);
+
+      for (string const& run: group) {
+        remove(run);
+      }
+    }
+    runs_ = merged;
+  }
+
+  merge_(runs_, [&outFiles](GroupedRead const& read) {
+    writeOutput_(outFiles, read);
+  });
+  removeRuns_();
+}
+
+size_t ClusterSorter::runs() const {
+  return spilled_;
+}
+
+/* Make a new run file name. */
+string ClusterSorter::runName_() {
+  return dirName_ + "/humid_run_" + to_string(names_++) + ".tmp";
+}
+
+/* Sort the reads in memory and write them to a new run file. */
+void ClusterSorter::spill_() {
+  if (buffer_.empty()) {
+    return;
+  }
+  sort(buffer_.begin(), buffer_.end(), before_);
+
+  runs_.push_back(runName_());
+  ofstream output(runs_.back(), ios::out | ios::binary);
+  for (GroupedRead const& read: buffer_) {
+    writeRun_(output, read);
+  }
+  if (not output) {
+    throw runtime_error("unable to write run file " + runs_.back());
+  }
+
+  buffer_.clear();
+  size_ = 0;
+  spilled_++;
+}
+
+/* Remove all remaining run files. */
+void ClusterSorter::removeRuns_() {
+  for (string const& run: runs_) {
+    remove(run);
+  }
+  runs_.clear();
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "output.h"
+
+using std::string;
+using std::vector;
+
+/*! Read annotated with its cluster, as kept by `ClusterSorter`. */
+struct GroupedRead {
+  uint32_t cluster {0};
+  bool representative {false};
+  uint64_t ordinal {0};      //!< Position in the input.
+  vector<string> reads {};   //!< Annotated record of every file.
+};
+
+
+/*! Bounded memory external sort that groups reads by cluster.
+ *
+ * Reads are collected in memory until the memory limit is reached, after
+ * which they are sorted and spilled to a run file. The runs are merged when
+ * the output is written, in multiple passes if there are more than `fanIn`
+ * of them. Within a cluster the representative read comes first, followed
+ * by the other reads in input order. Reads that could not be clustered
+ * (cluster 0) are written last.
+ */
+class ClusterSorter {
+public:
+  /*! Constructor.
+   *
+   * \param dirName Directory for the run files.
+   * \param memory Maximum number of bytes kept in memory.
+   * \param fanIn Maximum number of runs merged at once.
+   */
+  ClusterSorter(string const, size_t const = 1 << 28, size_t const = 64);
+  ClusterSorter(ClusterSorter const&) = delete;
+  ~ClusterSorter();
+
+  ClusterSorter& operator=(ClusterSorter const&) = delete;
+
+  /*! Add a read. Reads must be added in input order.
+   *
+   * \param cluster Cluster ID.
+   * \param representative Whether the read represents its cluster.
+   * \param reads Annotated record of every file.
+   */
+  void add(uint32_t const, bool const, vector<string>&&);
+
+  /*! Write all reads, grouped by cluster. The sorter is empty afterwards.
+   *
+   * \param outFiles Output files.
+   */
+  void write(vector<OutputFile*> const&);
+
+  /*! Get the number of runs spilled to disk.
+   *
+   * \return Number of runs.
+   */
+  size_t runs() const;
+
+private:
+  string runName_();
+  void spill_();
+  void removeRuns_();
+
+  string dirName_ {};
+  size_t memory_ {0};
+  size_t fanIn_ {0};
+  vector<GroupedRead> buffer_ {};
+  size_t size_ {0};
+  uint64_t ordinal_ {0};
+  vector<string> runs_ {};
+  size_t spilled_ {0};
+  size_t names_ {0};
+};
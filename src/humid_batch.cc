@@ -0,0 +1,107 @@
+#include <filesystem>
+#include <iomanip>
+
+#include "../lib/commandIO/src/commandIO.h"
+
+#include "batch.h"
+#include "dedup.h"
+#include "memory.h"
+
+using std::filesystem::create_directories;
+using std::fixed;
+using std::ios;
+using std::setprecision;
+
+
+/*! Determine duplicates for a batch of samples.
+ *
+ * \param wordLength Read length.
+ * \param distance Maximum distance between reads.
+ * \param logName Log file.
+ * \param runStats
+ * \param write
+ * \param sidecar Write the cluster ID of every read to a binary file.
+ * \param grouped Write annotated FastQ files grouped by cluster.
+ * \param radix Use a path-compressed trie to store the words.
+ * \param counters Report hardware event counts of every stage.
+ * \param barcode Only merge reads with the same cell barcode in the header.
+ * \param trim Remove the in-read UMIs from the written reads.
+ * \param budgets Distance budget for every segment of a word.
+ * \param whitelist UMI whitelist file name, empty to disable.
+ * \param structures Read structure of every file, empty to use the UMI in
+ *   the header.
+ * \param complexity Set reads aside if a single nucleotide makes up more than
+ *   this percentage of their word, 0 to keep all reads.
+ * \param threads Number of threads per sample.
+ * \param sampleSize Only estimate the statistics on a subsample of this
+ *   many reads, 0 to process all reads.
+ * \param workers Number of samples that are processed in parallel.
+ * \param budget Budget for the total input size of the running samples in
+ *   MiB.
+ * \param manifest Sample manifest.
+ */
+void humidBatch(
+    size_t const wordLength, size_t const distance, string const logName,
+    bool const runStats, bool const filter, bool const annotate,
+    bool const sidecar, bool const grouped, bool const edit,
+    bool const maximum, bool const radix, bool const counters,
+    bool const barcode, bool const trim, string const budgets,
+    string const whitelist, string const structures, size_t const complexity,
+    size_t const threads, size_t const sampleSize, size_t const workers,
+    size_t const budget, string const manifest) {
+  ofstream log(logName.c_str(), ios::out | ios::binary);
+
+  vector<Sample> samples {readManifest(manifest)};
+  log << "Processing " << samples.size() << " samples.\n" << std::flush;
+
+  size_t failed {runBatch(
+    samples, workers, budget << 20,
+    [&](Sample const& sample) {
+      create_directories(sample.dirName);
+      humid(
+        wordLength, distance, sample.dirName + "/humid.log",
+        sample.dirName, runStats, filter, annotate, sidecar, grouped, edit,
+        maximum, radix, counters, barcode, trim, budgets, whitelist,
+        structures, complexity, threads, sampleSize, "", sample.files);
+    },
+    log)};
+
+  log << "Done, " << failed << " samples failed.\n";
+  // The peak resident set size is that of the whole batch, since the samples
+  // share this process.
+  log << "Peak RSS: " << fixed << setprecision(1)
+    << peakRSS() / 1048576.0 << " MiB\n";
+}
+
+
+/* Argument parsing. */
+int main(int argc, char* argv[]) {
+  CliIO io(argc, argv);
+
+  interface(
+    io,
+    humidBatch, argv[0], "Deduplicate a batch of datasets.",
+      param("-n", 24, "word length"),
+      param("-m", 1, "allowed mismatches"),
+      param("-l", "/dev/stderr", "log file name"),
+      param("-s", false, "calculate statistics"),
+      param("-q", true, "write deduplicated FastQ files"),
+      param("-a", false, "write annotated FastQ files"),
+      param("-i", false, "write a binary cluster ID file"),
+      param("-o", false, "write FastQ files grouped by cluster"),
+      param("-e", false, "use edit distance"),
+      param("-x", false, "use maximum clustering method"),
+      param("-r", false, "use a path-compressed trie"),
+      param("-k", false, "report hardware performance counters"),
+      param("-y", false, "only merge reads with the same cell barcode"),
+      param("-z", false, "trim in-read UMIs from the written reads"),
+      param("-b", "", "allowed mismatches per segment"),
+      param("-w", "", "UMI whitelist"),
+      param("-f", "", "read structure of every file, e.g., 8M+T,+T"),
+      param("-c", 0, "maximum percentage of one nucleotide in a word"),
+      param("-t", 1, "number of threads per sample"),
+      param("-p", 0, "only estimate statistics on this many reads"),
+      param("-j", 1, "number of samples in parallel"),
+      param("-g", 0, "input size budget in MiB (0 for no limit)"),
+      param("manifest", "sample manifest"));
+}
@@ -4,6 +4,7 @@
 
 /*! Leaf structure for neighbour finding. */
 struct NLeaf : Leaf {
+  uint32_t id {0};  //!< Order of first occurrence, starting at 1.
   vector<NLeaf*> neighbours {};
   Cluster* cluster {nullptr};
 };
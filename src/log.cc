@@ -1,3 +1,4 @@
+#include "counters.h"
 #include "log.h"
 
 
@@ -5,11 +6,23 @@ time_t startMessage(ofstream& log, char const message[]) {
   log << message << "... ";
   log.flush();
 
+  if (StageCounters* const counters {stageCounters()}) {
+    counters->start(message);
+  }
+
   return time(nullptr);
 }
 
 void endMessage(ofstream& log, time_t const start) {
+  StageCounts const* stage {nullptr};
+  if (StageCounters* const counters {stageCounters()}) {
+    stage = counters->stop();
+  }
+
   time_t seconds {static_cast<time_t>(difftime(time(nullptr), start))};
   log << "done. (" << seconds / 60 << 'm' << seconds % 60 << "s)\n";
+  if (stage) {
+    countersMessage(log, stage->counts);
+  }
   log.flush();
 }
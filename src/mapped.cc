@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped.h"
+
+using std::min;
+using std::runtime_error;
+
+size_t const releaseSize_ {1 << 24};
+
+
+MappedFile::MappedFile(char const filename[]) {
+  int fd {open(filename, O_RDONLY)};
+  if (fd < 0) {
+    throw runtime_error(string("cannot open ") + filename);
+  }
+
+  struct stat st;
+  fstat(fd, &st);
+  size = st.st_size;
+
+  if (size) {
+    void* map {mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)};
+    if (map == MAP_FAILED) {
+      close(fd);
+      throw runtime_error(string("cannot map ") + filename);
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    data = static_cast<char const*>(map);
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data) {
+    munmap(const_cast<char*>(data), size);
+  }
+}
+
+void MappedFile::release(size_t const pos) {
+  size_t const pageSize {static_cast<size_t>(sysconf(_SC_PAGESIZE))};
+  size_t end {pos - pos % pageSize};
+  if (end - released_ >= releaseSize_) {
+    madvise(const_cast<char*>(data) + released_, end - released_,
+      MADV_DONTNEED);
+    released_ = end;
+  }
+}
+
+
+MappedFastq::MappedFastq(char const filename[]) : file_(filename) {}
+
+bool MappedFastq::read(Record& record) {
+  size_t consumed {parseRecord(
+    string_view(file_.data + pos_, file_.size - pos_), record, true)};
+  pos_ += consumed;
+
+  return consumed;
+}
+
+void MappedFastq::release() {
+  file_.release(pos_);
+}
+
+
+/* Read one line, without the line ending.
+ *
+ * \param data Buffer.
+ * \param pos Start of the line, moved to the start of the next line.
+ * \param final Whether a missing line ending is allowed.
+ * \param line Line.
+ *
+ * \return `true` if a line was found.
+ */
+bool line_(
+    string_view const data, size_t& pos, bool const final, string_view& line) {
+  size_t end {data.find('\n', pos)};
+  if (end == string_view::npos) {
+    if (not final) {
+      return false;
+    }
+    end = data.size();
+  }
+
+  line = data.substr(pos, end - pos);
+  if (line.ends_with('\r')) {
+    line.remove_suffix(1);
+  }
+  pos = min(end + 1, data.size());
+
+  return true;
+}
+
+size_t parseRecord(string_view const data, Record& record, bool const final) {
+  // Skip empty lines between records.
+  size_t start {data.find_first_not_of('\n')};
+  if (start == string_view::npos) {
+    return 0;
+  }
+
+  size_t pos {start};
+  string_view line;
+  if (not (
+      line_(data, pos, final, record.name) and
+      line_(data, pos, final, record.sequence) and
+      line_(data, pos, final, line) and
+      line_(data, pos, final, record.quality))) {
+    return 0;
+  }
+  record.text = data.substr(start, pos - start);
+
+  return pos;
+}
+
+bool mappable(string const filename) {
+  int fd {open(filename.c_str(), O_RDONLY)};
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  unsigned char magic[2] {};
+  bool result {
+    not fstat(fd, &st) and S_ISREG(st.st_mode) and
+    not (::read(fd, magic, 2) == 2 and magic[0] == 0x1f and magic[1] == 0x8b)};
+  close(fd);
+
+  return result;
+}
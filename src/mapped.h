@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+/*! FastQ record that refers to a buffer owned by a reader. */
+struct Record {
+  string_view name {};
+  string_view sequence {};
+  string_view text {};   //!< Complete record, including line endings.
+  string_view quality {};
+};
+
+
+/*! Reader that parses FastQ records in place. A record is valid until the
+ * next call to `release()`, so multiple records can be used at once.
+ */
+class RecordReader {
+public:
+  virtual ~RecordReader() {}
+
+  /*! Read one record.
+   *
+   * \param record Record.
+   *
+   * \return `true` if a record was read, `false` at the end of the file.
+   */
+  virtual bool read(Record&) = 0;
+
+  /*! Allow the reader to discard the buffers of all records read so far. */
+  virtual void release() {}
+};
+
+
+/*! Read-only memory mapped file. */
+class MappedFile {
+public:
+  MappedFile(char const[]);
+  ~MappedFile();
+
+  /*! Release the pages before `pos` once enough of them have accumulated.
+   *
+   * \param pos Position in the file.
+   */
+  void release(size_t const);
+
+  char const* data {nullptr};
+  size_t size {0};
+
+private:
+  size_t released_ {0};
+};
+
+
+/*! Memory mapped reader for uncompressed FastQ files.
+ *
+ * Pages that lie before the current record are released as the reader moves
+ * forward, whenever `release()` is called.
+ */
+class MappedFastq : public RecordReader {
+public:
+  MappedFastq(char const[]);
+
+  bool read(Record&);
+  void release();
+
+private:
+  MappedFile file_;
+  size_t pos_ {0};
+};
+
+
+/*! Parse one FastQ record.
+ *
+ * \param data Buffer starting at the record.
+ * \param record Record.
+ * \param final Whether `data` runs up to the end of the file, in which case
+ *   the last line does not need a line ending.
+ *
+ * \return Number of bytes consumed, 0 if no complete record was found.
+ */
+size_t parseRecord(string_view const, Record&, bool const);
+
+/*! Determine whether a file can be read with `MappedFastq`, i.e., whether it
+ * is a regular file that is not gzip compressed.
+ *
+ * \param filename File name.
+ *
+ * \return `true` if the file can be memory mapped.
+ */
+bool mappable(string const);
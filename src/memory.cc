@@ -0,0 +1,53 @@
+#include <iomanip>
+
+#include <sys/resource.h>
+
+#include "memory.h"
+
+using std::fixed;
+using std::setprecision;
+
+
+/* Write the usage of one kind of object to a log. */
+void usageMessage_(
+    ofstream& log, char const name[], ObjectUsage const& usage) {
+  if (usage.objects) {
+    log << "  " << name << ": " << usage.objects << " ("
+      << fixed << setprecision(1) << usage.bytes / 1048576.0 << " MiB)\n";
+  }
+}
+
+/* Write the usage of one kind of object to a statistics file. */
+void writeUsage_(
+    ofstream& output, char const name[], ObjectUsage const& usage) {
+  output << name << "_count: " << usage.objects << '\n';
+  output << name << "_bytes: " << usage.bytes << '\n';
+}
+
+
+size_t peakRSS() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss;
+#else
+  return usage.ru_maxrss * 1024;
+#endif
+}
+
+void memoryMessage(ofstream& log, MemoryUsage const& memory) {
+  usageMessage_(log, "nodes", memory.nodes);
+  usageMessage_(log, "leaves", memory.leaves);
+  usageMessage_(log, "neighbours", memory.neighbours);
+  usageMessage_(log, "clusters", memory.clusters);
+  usageMessage_(log, "reads", memory.reads);
+  log.flush();
+}
+
+void writeMemory(ofstream& output, MemoryUsage const& memory) {
+  writeUsage_(output, "nodes", memory.nodes);
+  writeUsage_(output, "leaves", memory.leaves);
+  writeUsage_(output, "neighbours", memory.neighbours);
+  writeUsage_(output, "clusters", memory.clusters);
+  writeUsage_(output, "reads", memory.reads);
+}
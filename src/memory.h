@@ -0,0 +1,46 @@
+#pragma once
+
+#include <fstream>
+
+using std::ofstream;
+
+/*! Number and total size of objects of one kind. */
+struct ObjectUsage {
+  size_t objects {0};
+  size_t bytes {0};
+};
+
+/*! Memory usage of the major data structures.
+ *
+ * The bytes of the trie nodes and leaves are exact for a radix trie, and
+ * estimated from the number of objects otherwise.
+ */
+struct MemoryUsage {
+  ObjectUsage nodes {};       //!< Trie nodes.
+  ObjectUsage leaves {};      //!< Trie leaves.
+  ObjectUsage neighbours {};  //!< Neighbour list entries.
+  ObjectUsage clusters {};    //!< Clusters.
+  ObjectUsage reads {};       //!< Leaf or cluster of every read.
+};
+
+/*! Get the peak resident set size of this process.
+ *
+ * This is a figure for the whole process, which may run several samples.
+ *
+ * \return Peak resident set size in bytes.
+ */
+size_t peakRSS();
+
+/*! Write the memory usage to a log.
+ *
+ * \param log Log file.
+ * \param memory Memory usage.
+ */
+void memoryMessage(ofstream&, MemoryUsage const&);
+
+/*! Write the memory usage to a statistics file.
+ *
+ * \param output Statistics file.
+ * \param memory Memory usage.
+ */
+void writeMemory(ofstream&, MemoryUsage const&);
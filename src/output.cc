@@ -0,0 +1,80 @@
+#include "output.h"
+
+using std::unique_lock;
+
+
+OutputFile::OutputFile(
+    string const fileName, size_t const bufferSize, size_t const buffers)
+    : bufferSize_ {bufferSize}, buffers_ {buffers} {
+  writer_ = new Writer(&options_, fileName, options_.compression);
+  buffer_.reserve(bufferSize_);
+  thread_ = thread(&OutputFile::run_, this);
+}
+
+OutputFile::~OutputFile() {
+  flush_();
+  {
+    unique_lock<mutex> guard {lock_};
+    done_ = true;
+  }
+  changed_.notify_all();
+  thread_.join();
+  delete writer_;
+}
+
+void OutputFile::write(string_view const data) {
+  if (buffer_.size() + data.size() > bufferSize_) {
+    flush_();
+  }
+  buffer_.append(data);
+}
+
+void OutputFile::put(char const c) {
+  if (buffer_.size() == bufferSize_) {
+    flush_();
+  }
+  buffer_.push_back(c);
+}
+
+/* Hand the current buffer to the writer thread, and take an empty one. */
+void OutputFile::flush_() {
+  if (buffer_.empty()) {
+    return;
+  }
+
+  unique_lock<mutex> guard {lock_};
+  changed_.wait(guard, [this]() { return full_.size() < buffers_; });
+  full_.push_back(std::move(buffer_));
+  if (free_.empty()) {
+    buffer_ = string {};
+    buffer_.reserve(bufferSize_);
+  }
+  else {
+    buffer_ = std::move(free_.back());
+    free_.pop_back();
+  }
+  guard.unlock();
+  changed_.notify_all();
+}
+
+/* Write buffers until the file is closed. */
+void OutputFile::run_() {
+  unique_lock<mutex> guard {lock_};
+  while (true) {
+    changed_.wait(guard, [this]() { return done_ or not full_.empty(); });
+    if (full_.empty()) {
+      return;
+    }
+
+    string data {std::move(full_.front())};
+    full_.pop_front();
+    guard.unlock();
+
+    writer_->write(data.data(), data.size());
+    data.clear();
+
+    guard.lock();
+    free_.push_back(std::move(data));
+    changed_.notify_all();
+  }
+}
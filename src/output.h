@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../lib/fastp/src/options.h"
+#include "../lib/fastp/src/writer.h"
+
+using std::condition_variable;
+using std::deque;
+using std::mutex;
+using std::string;
+using std::string_view;
+using std::thread;
+using std::vector;
+
+/*! Output file that collects data in large buffers, which are compressed
+ * and written by a dedicated thread.
+ */
+class OutputFile {
+public:
+  /*! Constructor.
+   *
+   * \param fileName Output file name.
+   * \param bufferSize Size of a buffer.
+   * \param buffers Maximum number of buffers waiting to be written.
+   */
+  OutputFile(string const, size_t const = 1 << 20, size_t const = 4);
+  OutputFile(OutputFile const&) = delete;
+  ~OutputFile();
+
+  OutputFile& operator=(OutputFile const&) = delete;
+
+  /*! Append data.
+   *
+   * \param data Data.
+   */
+  void write(string_view const);
+
+  /*! Append one character.
+   *
+   * \param c Character.
+   */
+  void put(char const);
+
+private:
+  void flush_();
+  void run_();
+
+  Options options_ {};
+  Writer* writer_ {nullptr};
+  size_t bufferSize_ {0};
+  size_t buffers_ {0};
+  string buffer_ {};
+  deque<string> full_ {};
+  vector<string> free_ {};
+  bool done_ {false};
+  mutex lock_ {};
+  condition_variable changed_ {};
+  thread thread_ {};
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+using std::copy;
+using std::vector;
+
+/* Range of words that share a prefix, i.e., a node of the implicit trie. */
+struct Range_ {
+  uint32_t begin {0};
+  uint32_t end {0};
+};
+
+
+/* Divide a range into the ranges of its children.
+ *
+ * \param words Concatenated words.
+ * \param length Word length.
+ * \param range Range of words that share a prefix of length `depth`.
+ * \param depth Depth of the range in the implicit trie.
+ * \param children Child range for every letter.
+ */
+inline void split_(
+    vector<uint8_t> const& words, size_t const length, Range_ const range,
+    size_t const depth, Range_ (&children)[4]) {
+  uint32_t begin {range.begin};
+  for (uint8_t letter {0}; letter < 4; letter++) {
+    // The letters at `depth` are sorted within the range.
+    uint32_t low {begin};
+    uint32_t high {range.end};
+    while (low < high) {
+      uint32_t const middle {low + (high - low) / 2};
+      if (words[middle * length + depth] <= letter) {
+        low = middle + 1;
+      }
+      else {
+        high = middle;
+      }
+    }
+    children[letter] = {begin, low};
+    begin = low;
+  }
+}
+
+/* Traverse a pair of nodes of the implicit trie.
+ *
+ * \param words Concatenated words.
+ * \param length Word length.
+ * \param a Range of the first node.
+ * \param b Range of the second node.
+ * \param depth Depth of both nodes.
+ * \param remaining Remaining distance.
+ * \param tied Whether `a` and `b` are the same node.
+ * \param f Function called for every pair.
+ */
+template <class F>
+void traverse_(
+    vector<uint8_t> const& words, size_t const length, Range_ const a,
+    Range_ const b, size_t const depth, size_t const remaining,
+    bool const tied, F const& f) {
+  if (depth == length) {
+    // The words are distinct, so a leaf holds a single word.
+    if (not tied) {
+      f(a.begin, b.begin);
+    }
+    return;
+  }
+
+  Range_ childrenA[4];
+  Range_ childrenB[4];
+  split_(words, length, a, depth, childrenA);
+  if (tied) {
+    copy(childrenA, childrenA + 4, childrenB);
+  }
+  else {
+    split_(words, length, b, depth, childrenB);
+  }
+
+  for (uint8_t i {0}; i < 4; i++) {
+    if (childrenA[i].begin == childrenA[i].end) {
+      continue;
+    }
+    // While tied, only the pairs in which `b` is not smaller than `a` are
+    // visited.
+    for (uint8_t j {tied ? i : uint8_t {0}}; j < 4; j++) {
+      if (
+          childrenB[j].begin == childrenB[j].end or
+          (i != j and not remaining)) {
+        continue;
+      }
+      traverse_(
+        words, length, childrenA[i], childrenB[j], depth + 1,
+        remaining - (i != j), tied and i == j, f);
+    }
+  }
+}
+
+
+/*! Visit all pairs of words within a Hamming distance of each other.
+ *
+ * The words are treated as an implicit trie, in which every node is the range
+ * of words that share a prefix. This trie is traversed jointly against
+ * itself, so the exploration of a shared prefix is done once for all words
+ * below it, instead of once per query word.
+ *
+ * The pairs are not collected. For every word, the pairs it takes part in
+ * are visited in order of the other word: all smaller ones first, in
+ * ascending order, followed by all larger ones, in ascending order.
+ *
+ * \param words Distinct words of equal length in lexicographic order,
+ *   concatenated.
+ * \param length Word length.
+ * \param distance Maximum distance.
+ * \param f Function called with word indices `(i, j)`, `i < j`, for every
+ *   pair.
+ */
+template <class F>
+void hammingPairs(
+    vector<uint8_t> const& words, size_t const length,
+    size_t const distance, F const& f) {
+  if (words.empty() or not length) {
+    return;
+  }
+
+  Range_ const root {0, static_cast<uint32_t>(words.size() / length)};
+  traverse_(words, length, root, root, 0, distance, true, f);
+}
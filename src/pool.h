@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using std::atomic;
+using std::min;
+using std::thread;
+using std::vector;
+
+/*! Apply a function to every index in a range, using a number of threads.
+ * The indices are handed out in order, one at a time.
+ *
+ * \param size Size of the range.
+ * \param threads Number of threads.
+ * \param f Function that takes an index and returns a count.
+ *
+ * \return Sum of the counts.
+ */
+template <class F>
+size_t parallelSum(size_t const size, size_t const threads, F const& f) {
+  atomic<size_t> next {0};
+  atomic<size_t> total {0};
+  auto worker {[&]() {
+    size_t sum {0};
+    for (size_t i {next++}; i < size; i = next++) {
+      sum += f(i);
+    }
+    total += sum;
+  }};
+
+  if (threads <= 1 or size <= 1) {
+    worker();
+    return total;
+  }
+
+  vector<thread> workers;
+  for (size_t i {0}; i < min(threads, size); i++) {
+    workers.emplace_back(worker);
+  }
+  for (thread& w: workers) {
+    w.join();
+  }
+  return total;
+}
@@ -0,0 +1,475 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "../lib/trie/src/trie.tcc"
+
+#include "arena.tcc"
+
+using std::min;
+
+uint8_t const maxLabel_ {32};
+
+/*! Node of a path-compressed trie over the alphabet {0, 1, 2, 3}.
+ *
+ * Every node holds the letters on the edge from its parent, packed two bits
+ * per letter, so unary chains of up to 32 letters take a single node.
+ */
+template <class LeafType>
+struct RadixNode {
+  /*! Get a letter of the edge label.
+   *
+   * \param i Position in the label.
+   *
+   * \return Letter.
+   */
+  uint8_t letter(uint8_t const) const;
+
+  uint64_t label {0};
+  uint8_t length {0};
+  RadixNode* child[4] {};
+  LeafType* leaf {nullptr};
+};
+
+
+/*! Path-compressed (radix) trie with the same interface as `Trie<4, LeafType>`.
+ *
+ * Nodes and leaves are never removed, so they are taken from arenas and are
+ * all released at once when the trie is destroyed.
+ */
+template <class LeafType=Leaf>
+class RadixTrie {
+public:
+  RadixTrie();
+  RadixTrie(RadixTrie const&) = delete;
+
+  RadixTrie& operator=(RadixTrie const&) = delete;
+
+  /*! Add a word.
+   *
+   * \param word Word.
+   *
+   * \return Node corresponding to `word`.
+   */
+  RadixNode<LeafType>* add(vector<uint8_t> const&);
+
+  /*! Find a word.
+   *
+   * \param word Word.
+   *
+   * \return Node corresponding to `word` if found, `nullptr` otherwise.
+   */
+  RadixNode<LeafType>* find(vector<uint8_t> const&) const;
+
+  /*! Traverse all words in lexicographic order.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> walk() const;
+
+  /*! Find all words within Hamming distance `distance` of `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> hamming(
+    vector<uint8_t> const&, int const) const;
+
+  /*! Find all words within Hamming distance `distance` of `word` that are
+   * not lexicographically smaller than `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> asymmetricHamming(
+    vector<uint8_t> const&, int const) const;
+
+  /*! Find all words within Levenshtein distance `distance` of `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> levenshtein(
+    vector<uint8_t> const&, int const) const;
+
+  /*! Find all words within Levenshtein distance `distance` of `word` that are
+   * not lexicographically smaller than `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> asymmetricLevenshtein(
+    vector<uint8_t> const&, int const) const;
+
+  /*! Count the nodes.
+   *
+   * \return Number of nodes, including the root.
+   */
+  size_t nodes() const;
+
+  /*! Get the memory allocated for the nodes.
+   *
+   * \return Number of bytes.
+   */
+  size_t nodeBytes() const;
+
+  /*! Get the memory allocated for the leaves.
+   *
+   * \return Number of bytes.
+   */
+  size_t leafBytes() const;
+
+private:
+  RadixNode<LeafType>* newNode_(
+    vector<uint8_t> const&, size_t const, size_t const);
+  void split_(RadixNode<LeafType>*, uint8_t const);
+
+  generator<Result<LeafType>> walk_(
+    RadixNode<LeafType> const*, vector<uint8_t>&) const;
+  generator<Result<LeafType>> hamming_(
+    RadixNode<LeafType> const*, vector<uint8_t> const&, int const, bool const,
+    vector<uint8_t>&) const;
+  generator<Result<LeafType>> levenshtein_(
+    RadixNode<LeafType> const*, vector<uint8_t> const&, vector<int> const&,
+    int const, bool const, vector<uint8_t>&) const;
+
+  Arena<RadixNode<LeafType>> nodeArena_ {};
+  Arena<LeafType> leafArena_ {};
+  RadixNode<LeafType>* root_;
+};
+
+
+template <class LeafType>
+uint8_t RadixNode<LeafType>::letter(uint8_t const i) const {
+  return (label >> (2 * i)) & 3;
+}
+
+
+template <class LeafType>
+RadixTrie<LeafType>::RadixTrie() {
+  root_ = nodeArena_.make();
+}
+
+/* Make a node that holds up to 32 letters of `word`.
+ *
+ * \param word Word.
+ * \param pos Start of the label in `word`.
+ * \param length Length of the label.
+ *
+ * \return New node.
+ */
+template <class LeafType>
+RadixNode<LeafType>* RadixTrie<LeafType>::newNode_(
+    vector<uint8_t> const& word, size_t const pos, size_t const length) {
+  RadixNode<LeafType>* node {nodeArena_.make()};
+  node->length = length;
+  for (uint8_t i {0}; i < length; i++) {
+    node->label |= static_cast<uint64_t>(word[pos + i]) << (2 * i);
+  }
+  return node;
+}
+
+/* Split a node, such that it keeps the first `length` letters of its label.
+ *
+ * \param node Node.
+ * \param length Length of the label that is kept.
+ */
+template <class LeafType>
+void RadixTrie<LeafType>::split_(
+    RadixNode<LeafType>* node, uint8_t const length) {
+  RadixNode<LeafType>* tail {nodeArena_.make()};
+  tail->label = node->label >> (2 * length);
+  tail->length = node->length - length;
+  tail->leaf = node->leaf;
+  for (uint8_t i {0}; i < 4; i++) {
+    tail->child[i] = node->child[i];
+    node->child[i] = nullptr;
+  }
+
+  node->label &= (uint64_t(1) << (2 * length)) - 1;
+  node->length = length;
+  node->leaf = nullptr;
+  node->child[tail->letter(0)] = tail;
+}
+
+template <class LeafType>
+RadixNode<LeafType>* RadixTrie<LeafType>::add(
+    vector<uint8_t> const& word) {
+  RadixNode<LeafType>* node {root_};
+  size_t pos {0};
+  while (pos < word.size()) {
+    RadixNode<LeafType>*& child {node->child[word[pos]]};
+    if (not child) {
+      // Add the remainder of the word as a chain of new nodes.
+      size_t length {min(word.size() - pos, size_t(maxLabel_))};
+      child = newNode_(word, pos, length);
+      pos += length;
+    }
+    else {
+      // Follow the label as far as it matches, and split it if needed.
+      uint8_t length {0};
+      while (
+          length < child->length and pos + length < word.size() and
+          child->letter(length) == word[pos + length]) {
+        length++;
+      }
+      if (length < child->length) {
+        split_(child, length);
+      }
+      pos += length;
+    }
+    node = child;
+  }
+
+  if (not node->leaf) {
+    node->leaf = leafArena_.make();
+  }
+  node->leaf->count++;
+
+  return node;
+}
+
+template <class LeafType>
+RadixNode<LeafType>* RadixTrie<LeafType>::find(
+    vector<uint8_t> const& word) const {
+  RadixNode<LeafType>* node {root_};
+  size_t pos {0};
+  while (pos < word.size()) {
+    node = node->child[word[pos]];
+    if (not node or pos + node->length > word.size()) {
+      return nullptr;
+    }
+    for (uint8_t i {0}; i < node->length; i++) {
+      if (node->letter(i) != word[pos + i]) {
+        return nullptr;
+      }
+    }
+    pos += node->length;
+  }
+
+  if (not node->leaf) {
+    return nullptr;
+  }
+  return node;
+}
+
+
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::walk_(
+    RadixNode<LeafType> const* node, vector<uint8_t>& path) const {
+  if (node->leaf) {
+    Result<LeafType> result {path, node->leaf};
+    co_yield result;
+  }
+
+  for (RadixNode<LeafType> const* const child: node->child) {
+    if (child) {
+      for (uint8_t i {0}; i < child->length; i++) {
+        path.push_back(child->letter(i));
+      }
+      for (Result<LeafType> const& result: walk_(child, path)) {
+        co_yield result;
+      }
+      path.resize(path.size() - child->length);
+    }
+  }
+}
+
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::walk() const {
+  vector<uint8_t> path;
+  for (Result<LeafType> const& result: walk_(root_, path)) {
+    co_yield result;
+  }
+}
+
+
+/* Find words within Hamming distance.
+ *
+ * \param node Current node.
+ * \param word Word.
+ * \param distance Remaining distance.
+ * \param tied Whether the path is equal to the start of `word`, only used
+ *   for the asymmetric search.
+ * \param path Path to the current node.
+ */
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::hamming_(
+    RadixNode<LeafType> const* node, vector<uint8_t> const& word,
+    int const distance, bool const tied, vector<uint8_t>& path) const {
+  if (path.size() == word.size()) {
+    if (node->leaf) {
+      Result<LeafType> result {path, node->leaf};
+      co_yield result;
+    }
+    co_return;
+  }
+
+  for (RadixNode<LeafType> const* const child: node->child) {
+    if (not child or path.size() + child->length > word.size()) {
+      continue;
+    }
+
+    size_t const pos {path.size()};
+    int remaining {distance};
+    bool stillTied {tied};
+    bool valid {true};
+    for (uint8_t i {0}; i < child->length and valid; i++) {
+      uint8_t const letter {child->letter(i)};
+      if (letter != word[pos + i]) {
+        // In the asymmetric search, a path may not become smaller than word.
+        valid = not (stillTied and letter < word[pos + i]) and --remaining >= 0;
+        stillTied = false;
+      }
+    }
+
+    if (valid) {
+      for (uint8_t i {0}; i < child->length; i++) {
+        path.push_back(child->letter(i));
+      }
+      for (Result<LeafType> const& result: hamming_(
+          child, word, remaining, stillTied, path)) {
+        co_yield result;
+      }
+      path.resize(pos);
+    }
+  }
+}
+
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::hamming(
+    vector<uint8_t> const& word, int const distance) const {
+  vector<uint8_t> path;
+  for (Result<LeafType> const& result: hamming_(
+      root_, word, distance, false, path)) {
+    co_yield result;
+  }
+}
+
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::asymmetricHamming(
+    vector<uint8_t> const& word, int const distance) const {
+  vector<uint8_t> path;
+  for (Result<LeafType> const& result: hamming_(
+      root_, word, distance, true, path)) {
+    co_yield result;
+  }
+}
+
+
+/* Find words within Levenshtein distance.
+ *
+ * \param node Current node.
+ * \param word Word.
+ * \param row Edit distances between the path and every prefix of `word`.
+ * \param distance Maximum distance.
+ * \param tied Whether the path is equal to the start of `word`, only used
+ *   for the asymmetric search.
+ * \param path Path to the current node.
+ */
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::levenshtein_(
+    RadixNode<LeafType> const* node, vector<uint8_t> const& word,
+    vector<int> const& row, int const distance, bool const tied,
+    vector<uint8_t>& path) const {
+  if (node->leaf and row.back() <= distance) {
+    Result<LeafType> result {path, node->leaf};
+    co_yield result;
+  }
+
+  for (RadixNode<LeafType> const* const child: node->child) {
+    if (not child) {
+      continue;
+    }
+
+    size_t const pos {path.size()};
+    vector<int> current {row};
+    bool stillTied {tied};
+    bool valid {true};
+    for (uint8_t i {0}; i < child->length and valid; i++) {
+      uint8_t const letter {child->letter(i)};
+      if (stillTied and (pos + i >= word.size() or letter != word[pos + i])) {
+        // In the asymmetric search, a path may not become smaller than word.
+        valid = pos + i >= word.size() or letter > word[pos + i];
+        stillTied = false;
+      }
+
+      // Calculate the next row of the edit distance matrix.
+      vector<int> previous {current};
+      current[0] = previous[0] + 1;
+      int minimum {current[0]};
+      for (size_t j {1}; j < current.size(); j++) {
+        current[j] = min({
+          previous[j] + 1, current[j - 1] + 1,
+          previous[j - 1] + (word[j - 1] != letter)});
+        minimum = min(minimum, current[j]);
+      }
+      valid = valid and minimum <= distance;
+    }
+
+    if (valid) {
+      for (uint8_t i {0}; i < child->length; i++) {
+        path.push_back(child->letter(i));
+      }
+      for (Result<LeafType> const& result: levenshtein_(
+          child, word, current, distance, stillTied, path)) {
+        co_yield result;
+      }
+      path.resize(pos);
+    }
+  }
+}
+
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::levenshtein(
+    vector<uint8_t> const& word, int const distance) const {
+  vector<int> row(word.size() + 1);
+  for (size_t j {0}; j < row.size(); j++) {
+    row[j] = j;
+  }
+
+  vector<uint8_t> path;
+  for (Result<LeafType> const& result: levenshtein_(
+      root_, word, row, distance, false, path)) {
+    co_yield result;
+  }
+}
+
+template <class LeafType>
+generator<Result<LeafType>> RadixTrie<LeafType>::asymmetricLevenshtein(
+    vector<uint8_t> const& word, int const distance) const {
+  vector<int> row(word.size() + 1);
+  for (size_t j {0}; j < row.size(); j++) {
+    row[j] = j;
+  }
+
+  vector<uint8_t> path;
+  for (Result<LeafType> const& result: levenshtein_(
+      root_, word, row, distance, true, path)) {
+    co_yield result;
+  }
+}
+
+template <class LeafType>
+size_t RadixTrie<LeafType>::nodes() const {
+  return nodeArena_.size();
+}
+
+template <class LeafType>
+size_t RadixTrie<LeafType>::nodeBytes() const {
+  return nodeArena_.bytes();
+}
+
+template <class LeafType>
+size_t RadixTrie<LeafType>::leafBytes() const {
+  return leafArena_.bytes();
+}
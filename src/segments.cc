@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "segments.h"
+
+using std::accumulate;
+using std::count;
+using std::invalid_argument;
+using std::istringstream;
+using std::min;
+
+
+Segments makeSegments(
+    size_t const headerUMISize, vector<size_t> const& ntToTake,
+    string const budgets, size_t const distance) {
+  Segments segments;
+
+  if (budgets.empty()) {
+    segments.lengths.push_back(
+      accumulate(ntToTake.begin(), ntToTake.end(), headerUMISize));
+    segments.budgets.push_back(distance);
+    return segments;
+  }
+
+  if (headerUMISize) {
+    segments.lengths.push_back(headerUMISize);
+  }
+  segments.lengths.insert(
+    segments.lengths.end(), ntToTake.begin(), ntToTake.end());
+
+  istringstream input(budgets);
+  string budget;
+  while (getline(input, budget, ',')) {
+    segments.budgets.push_back(stoul(budget));
+  }
+
+  if (segments.budgets.size() != segments.lengths.size()) {
+    throw invalid_argument(
+      "expected " + std::to_string(segments.lengths.size()) + " budgets");
+  }
+
+  return segments;
+}
+
+Segments exactPrefix(Segments const& segments, size_t const length) {
+  Segments exact;
+  size_t remaining {length};
+  for (size_t i {0}; i < segments.lengths.size(); i++) {
+    size_t const taken {min(remaining, segments.lengths[i])};
+    if (taken) {
+      exact.lengths.push_back(taken);
+      exact.budgets.push_back(0);
+      remaining -= taken;
+    }
+    if (taken < segments.lengths[i]) {
+      exact.lengths.push_back(segments.lengths[i] - taken);
+      exact.budgets.push_back(segments.budgets[i]);
+    }
+  }
+  return exact;
+}
+
+bool partitioned(Segments const& segments) {
+  for (size_t const budget: segments.budgets) {
+    if (not budget) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t fuzzyDistance(Segments const& segments) {
+  return accumulate(segments.budgets.begin(), segments.budgets.end(), 0ul);
+}
+
+size_t fuzzySegments(Segments const& segments) {
+  return segments.budgets.size() - count(
+    segments.budgets.begin(), segments.budgets.end(), size_t {0});
+}
+
+void splitWord(
+    vector<uint8_t> const& word, Segments const& segments, string& key,
+    vector<uint8_t>& fuzzy) {
+  key.clear();
+  fuzzy.clear();
+
+  size_t pos {0};
+  for (size_t i {0}; i < segments.lengths.size(); i++) {
+    size_t const end {pos + segments.lengths[i]};
+    if (segments.budgets[i]) {
+      fuzzy.insert(fuzzy.end(), word.begin() + pos, word.begin() + end);
+    }
+    else {
+      key.append(word.begin() + pos, word.begin() + end);
+    }
+    pos = end;
+  }
+}
+
+bool withinBudgets(
+    span<uint8_t const> const a, span<uint8_t const> const b,
+    Segments const& segments) {
+  size_t pos {0};
+  for (size_t i {0}; i < segments.lengths.size(); i++) {
+    if (segments.budgets[i]) {
+      size_t distance {0};
+      for (size_t j {pos}; j < pos + segments.lengths[i]; j++) {
+        distance += a[j] != b[j];
+      }
+      if (distance > segments.budgets[i]) {
+        return false;
+      }
+      pos += segments.lengths[i];
+    }
+  }
+  return true;
+}
+
+bool withinBudgets(
+    vector<uint8_t> const& a, vector<uint8_t> const& b,
+    Segments const& segments) {
+  return withinBudgets(
+    span<uint8_t const> {a}, span<uint8_t const> {b}, segments);
+}
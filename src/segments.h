@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+using std::span;
+using std::string;
+using std::vector;
+
+/*! Division of a word into segments, each with its own distance budget.
+ *
+ * Segments with a budget of 0 must match exactly, and are used to partition
+ * the words. The remaining segments form the part of the word that is used
+ * for the neighbour search.
+ */
+struct Segments {
+  vector<size_t> lengths {};
+  vector<size_t> budgets {};
+};
+
+
+/*! Make the segments of a word.
+ *
+ * \param headerUMISize Nucleotides taken from the UMI header.
+ * \param ntToTake Nucleotides taken from each file.
+ * \param budgets Comma separated list of budgets, one for the UMI header (if
+ *   present) and one for each file. If empty, the whole word is one segment.
+ * \param distance Budget used when `budgets` is empty.
+ *
+ * \return Segments.
+ */
+Segments makeSegments(
+  size_t const, vector<size_t> const&, string const, size_t const);
+
+/*! Make the first letters of a word match exactly, splitting a segment if
+ * needed. The remainder of a split segment keeps its budget.
+ *
+ * \param segments Segments.
+ * \param length Number of letters that must match exactly.
+ *
+ * \return Segments.
+ */
+Segments exactPrefix(Segments const&, size_t const);
+
+/*! Determine whether some segments must match exactly.
+ *
+ * \param segments Segments.
+ *
+ * \return `true` if words must be partitioned.
+ */
+bool partitioned(Segments const&);
+
+/*! Total budget of the segments that do not need to match exactly.
+ *
+ * \param segments Segments.
+ *
+ * \return Maximum distance for the neighbour search.
+ */
+size_t fuzzyDistance(Segments const&);
+
+/*! Count the segments that do not need to match exactly.
+ *
+ * \param segments Segments.
+ *
+ * \return Number of segments with a budget.
+ */
+size_t fuzzySegments(Segments const&);
+
+/*! Split a word into the part that must match exactly and the rest.
+ *
+ * \param word Word.
+ * \param segments Segments.
+ * \param key Part of the word that must match exactly.
+ * \param fuzzy Remainder of the word.
+ */
+void splitWord(
+  vector<uint8_t> const&, Segments const&, string&, vector<uint8_t>&);
+
+/*! Determine whether the Hamming distance in every segment is within its
+ * budget, for words from which the exact segments have been removed.
+ *
+ * \param a Word.
+ * \param b Word.
+ * \param segments Segments.
+ *
+ * \return `true` if all segments are within budget.
+ */
+bool withinBudgets(
+  span<uint8_t const> const, span<uint8_t const> const, Segments const&);
+
+/*! \copydoc withinBudgets */
+bool withinBudgets(
+  vector<uint8_t> const&, vector<uint8_t> const&, Segments const&);
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "../lib/trie/src/trie.tcc"
+
+using std::declval;
+using std::logic_error;
+using std::remove_pointer_t;
+
+/*! Word store that divides the words over independent tries by their first
+ * letters. Words in different shards can be added concurrently, and the
+ * traversals give the same results, in the same order, as a single trie.
+ *
+ * The Levenshtein searches are only supported without a prefix, as an
+ * insertion or deletion can move letters across the shard boundary.
+ */
+template <class WordStore>
+class ShardedTrie {
+public:
+  using Node = remove_pointer_t<decltype(
+    declval<WordStore&>().add(declval<vector<uint8_t> const&>()))>;
+  using LeafType = remove_pointer_t<decltype(declval<Node&>().leaf)>;
+
+  /*! Constructor.
+   *
+   * \param prefix Number of letters used to select a shard.
+   */
+  ShardedTrie(size_t const = 0);
+  ShardedTrie(ShardedTrie const&) = delete;
+  ShardedTrie& operator=(ShardedTrie const&) = delete;
+  ~ShardedTrie();
+
+  /*! Determine the shard of a word.
+   *
+   * \param word Word.
+   *
+   * \return Shard index.
+   */
+  size_t shard(vector<uint8_t> const&) const;
+
+  /*! Get the number of shards.
+   *
+   * \return Number of shards.
+   */
+  size_t shards() const;
+
+  /*! Get a shard.
+   *
+   * \param i Shard index.
+   *
+   * \return Trie holding the words of shard `i` without their prefix, or
+   *   `nullptr` if the shard is empty.
+   */
+  WordStore const* store(size_t const) const;
+
+  /*! Add a word. Words in different shards may be added concurrently.
+   *
+   * \param word Word.
+   *
+   * \return Node corresponding to `word`.
+   */
+  Node* add(vector<uint8_t> const&);
+
+  /*! Find a word.
+   *
+   * \param word Word.
+   *
+   * \return Node corresponding to `word` if found, `nullptr` otherwise.
+   */
+  Node* find(vector<uint8_t> const&) const;
+
+  /*! Traverse all words in lexicographic order.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> walk() const;
+
+  /*! Find all words within Hamming distance `distance` of `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> hamming(
+    vector<uint8_t> const&, int const) const;
+
+  /*! Find all words within Hamming distance `distance` of `word` that are
+   * not lexicographically smaller than `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> asymmetricHamming(
+    vector<uint8_t> const&, int const) const;
+
+  /*! Find all words within Levenshtein distance `distance` of `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> levenshtein(
+    vector<uint8_t> const&, int const) const;
+
+  /*! Find all words within Levenshtein distance `distance` of `word` that are
+   * not lexicographically smaller than `word`.
+   *
+   * \param word Word.
+   * \param distance Maximum distance.
+   *
+   * \return Traversal results.
+   */
+  generator<Result<LeafType>> asymmetricLevenshtein(
+    vector<uint8_t> const&, int const) const;
+
+private:
+  vector<uint8_t> suffix_(vector<uint8_t> const&) const;
+  int distance_(vector<uint8_t> const&, size_t const) const;
+  Result<LeafType> prefixed_(size_t const, Result<LeafType> const&) const;
+  generator<Result<LeafType>> hamming_(
+    vector<uint8_t> const&, int const, bool const) const;
+
+  size_t prefix_;
+  vector<WordStore*> stores_;
+};
+
+
+template <class WordStore>
+ShardedTrie<WordStore>::ShardedTrie(size_t const prefix)
+    : prefix_ {prefix}, stores_(size_t {1} << (2 * prefix)) {}
+
+template <class WordStore>
+ShardedTrie<WordStore>::~ShardedTrie() {
+  for (WordStore* const store: stores_) {
+    delete store;
+  }
+}
+
+template <class WordStore>
+size_t ShardedTrie<WordStore>::shard(vector<uint8_t> const& word) const {
+  size_t index {0};
+  for (size_t i {0}; i < prefix_; i++) {
+    index = index << 2 | word[i];
+  }
+  return index;
+}
+
+template <class WordStore>
+size_t ShardedTrie<WordStore>::shards() const {
+  return stores_.size();
+}
+
+template <class WordStore>
+WordStore const* ShardedTrie<WordStore>::store(size_t const i) const {
+  return stores_[i];
+}
+
+/* Remove the shard prefix from a word.
+ *
+ * \param word Word.
+ *
+ * \return Remainder of `word`.
+ */
+template <class WordStore>
+vector<uint8_t> ShardedTrie<WordStore>::suffix_(
+    vector<uint8_t> const& word) const {
+  return vector<uint8_t>(word.begin() + prefix_, word.end());
+}
+
+/* Calculate the Hamming distance between the prefix of a word and the prefix
+ * of a shard.
+ *
+ * \param word Word.
+ * \param i Shard index.
+ *
+ * \return Hamming distance.
+ */
+template <class WordStore>
+int ShardedTrie<WordStore>::distance_(
+    vector<uint8_t> const& word, size_t const i) const {
+  int distance {0};
+  for (size_t j {0}; j < prefix_; j++) {
+    distance += word[j] != (i >> (2 * (prefix_ - j - 1)) & 3);
+  }
+  return distance;
+}
+
+/* Add the prefix of a shard to a traversal result.
+ *
+ * \param i Shard index.
+ * \param result Traversal result of shard `i`.
+ *
+ * \return Traversal result with the full path.
+ */
+template <class WordStore>
+auto ShardedTrie<WordStore>::prefixed_(
+    size_t const i, Result<LeafType> const& result) const
+    -> Result<LeafType> {
+  Result<LeafType> full {vector<uint8_t>(prefix_), result.leaf};
+  for (size_t j {0}; j < prefix_; j++) {
+    full.path[j] = i >> (2 * (prefix_ - j - 1)) & 3;
+  }
+  full.path.insert(full.path.end(), result.path.begin(), result.path.end());
+  return full;
+}
+
+template <class WordStore>
+auto ShardedTrie<WordStore>::add(vector<uint8_t> const& word) -> Node* {
+  WordStore*& store {stores_[shard(word)]};
+  if (not store) {
+    store = new WordStore;
+  }
+  if (not prefix_) {
+    return store->add(word);
+  }
+  return store->add(suffix_(word));
+}
+
+template <class WordStore>
+auto ShardedTrie<WordStore>::find(vector<uint8_t> const& word) const
+    -> Node* {
+  WordStore const* const store {stores_[shard(word)]};
+  if (not store) {
+    return nullptr;
+  }
+  if (not prefix_) {
+    return store->find(word);
+  }
+  return store->find(suffix_(word));
+}
+
+template <class WordStore>
+auto ShardedTrie<WordStore>::walk() const -> generator<Result<LeafType>> {
+  for (size_t i {0}; i < stores_.size(); i++) {
+    if (stores_[i]) {
+      for (Result<LeafType> const& result: stores_[i]->walk()) {
+        if (not prefix_) {
+          co_yield result;
+        }
+        else {
+          Result<LeafType> const full {prefixed_(i, result)};
+          co_yield full;
+        }
+      }
+    }
+  }
+}
+
+/* Find words within Hamming distance in every shard that can hold one. The
+ * shards are visited in lexicographic order of their prefixes.
+ *
+ * \param word Word.
+ * \param distance Maximum distance.
+ * \param asymmetric Skip words that are lexicographically smaller than
+ *   `word`.
+ */
+template <class WordStore>
+auto ShardedTrie<WordStore>::hamming_(
+    vector<uint8_t> const& word, int const distance,
+    bool const asymmetric) const -> generator<Result<LeafType>> {
+  vector<uint8_t> const suffix {suffix_(word)};
+  size_t const own {shard(word)};
+  for (size_t i {asymmetric ? own : 0}; i < stores_.size(); i++) {
+    int const remaining {distance - distance_(word, i)};
+    if (not stores_[i] or remaining < 0) {
+      continue;
+    }
+
+    // Only the shard of `word` itself holds words with the same prefix, all
+    // words in later shards are larger.
+    if (asymmetric and i == own) {
+      for (Result<LeafType> const& result: stores_[i]->asymmetricHamming(
+          suffix, remaining)) {
+        if (not prefix_) {
+          co_yield result;
+        }
+        else {
+          Result<LeafType> const full {prefixed_(i, result)};
+          co_yield full;
+        }
+      }
+    }
+    else {
+      for (Result<LeafType> const& result: stores_[i]->hamming(
+          suffix, remaining)) {
+        if (not prefix_) {
+          co_yield result;
+        }
+        else {
+          Result<LeafType> const full {prefixed_(i, result)};
+          co_yield full;
+        }
+      }
+    }
+  }
+}
+
+template <class WordStore>
+auto ShardedTrie<WordStore>::hamming(
+    vector<uint8_t> const& word, int const distance) const
+    -> generator<Result<LeafType>> {
+  return hamming_(word, distance, false);
+}
+
+template <class WordStore>
+auto ShardedTrie<WordStore>::asymmetricHamming(
+    vector<uint8_t> const& word, int const distance) const
+    -> generator<Result<LeafType>> {
+  return hamming_(word, distance, true);
+}
+
+template <class WordStore>
+auto ShardedTrie<WordStore>::levenshtein(
+    vector<uint8_t> const& word, int const distance) const
+    -> generator<Result<LeafType>> {
+  if (prefix_) {
+    throw logic_error("Levenshtein search in a sharded trie");
+  }
+  if (stores_.front()) {
+    for (Result<LeafType> const& result: stores_.front()->levenshtein(
+        word, distance)) {
+      co_yield result;
+    }
+  }
+}
+
+template <class WordStore>
+auto ShardedTrie<WordStore>::asymmetricLevenshtein(
+    vector<uint8_t> const& word, int const distance) const
+    -> generator<Result<LeafType>> {
+  if (prefix_) {
+    throw logic_error("Levenshtein search in a sharded trie");
+  }
+  if (stores_.front()) {
+    for (Result<LeafType> const& result:
+        stores_.front()->asymmetricLevenshtein(word, distance)) {
+      co_yield result;
+    }
+  }
+}
@@ -0,0 +1,104 @@
+#include <stdexcept>
+
+#include "sidecar.h"
+
+using std::ios;
+using std::min;
+using std::ofstream;
+using std::overflow_error;
+using std::runtime_error;
+
+char const magic_[] {"HUMIDCID"};
+size_t const magicSize_ {8};
+size_t const chunkSize_ {1 << 16};  // Reads per chunk.
+
+
+/* Encode an integer in little-endian byte order. */
+template <class T>
+void encode_(T const value, uint8_t* const data) {
+  for (size_t i {0}; i < sizeof(T); i++) {
+    data[i] = value >> (8 * i);
+  }
+}
+
+/* Decode an integer in little-endian byte order. */
+template <class T>
+T decode_(uint8_t const* const data) {
+  T value {0};
+  for (size_t i {0}; i < sizeof(T); i++) {
+    value |= static_cast<T>(data[i]) << (8 * i);
+  }
+  return value;
+}
+
+
+void writeSidecar(string const fileName, ReadClusters const& clusters) {
+  ofstream output(fileName.c_str(), ios::out | ios::binary);
+
+  uint8_t header[magicSize_ + sizeof(uint64_t)];
+  std::copy(magic_, magic_ + magicSize_, header);
+  encode_<uint64_t>(clusters.ids.size(), header + magicSize_);
+  output.write(reinterpret_cast<char const*>(header), sizeof(header));
+
+  vector<uint8_t> buffer;
+  for (size_t i {0}; i < clusters.ids.size(); i += chunkSize_) {
+    size_t const size {min(chunkSize_, clusters.ids.size() - i)};
+    buffer.resize(size * sizeof(uint32_t));
+    for (size_t j {0}; j < size; j++) {
+      uint32_t const id {clusters.ids[i + j]};
+      if (id >> 31) {
+        throw overflow_error("cluster ID does not fit in 31 bits");
+      }
+      encode_<uint32_t>(
+        id | clusters.representative[i + j] << 31,
+        buffer.data() + j * sizeof(uint32_t));
+    }
+    output.write(
+      reinterpret_cast<char const*>(buffer.data()), buffer.size());
+  }
+
+  if (not output) {
+    throw runtime_error("could not write " + fileName);
+  }
+}
+
+
+SidecarReader::SidecarReader(string const fileName)
+    : input_ {fileName.c_str(), ios::in | ios::binary} {
+  uint8_t header[magicSize_ + sizeof(uint64_t)];
+  if (
+      not input_.read(reinterpret_cast<char*>(header), sizeof(header)) or
+      not std::equal(magic_, magic_ + magicSize_, header)) {
+    throw runtime_error("not a cluster ID file: " + fileName);
+  }
+  size_ = decode_<uint64_t>(header + magicSize_);
+  remaining_ = size_;
+}
+
+size_t SidecarReader::size() const {
+  return size_;
+}
+
+bool SidecarReader::read(uint32_t& cluster, bool& representative) {
+  if (position_ == buffer_.size()) {
+    if (not remaining_) {
+      return false;
+    }
+
+    size_t const size {min(chunkSize_, remaining_)};
+    buffer_.resize(size * sizeof(uint32_t));
+    if (not input_.read(
+        reinterpret_cast<char*>(buffer_.data()), buffer_.size())) {
+      throw runtime_error("truncated cluster ID file");
+    }
+    remaining_ -= size;
+    position_ = 0;
+  }
+
+  uint32_t const value {decode_<uint32_t>(buffer_.data() + position_)};
+  cluster = value & ~(uint32_t {1} << 31);
+  representative = value >> 31;
+  position_ += sizeof(uint32_t);
+
+  return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cluster.h"
+
+using std::ifstream;
+using std::string;
+using std::vector;
+
+/*! Write the cluster assignment of every read to a binary file.
+ *
+ * The file starts with the magic string `HUMIDCID` (8 bytes), followed by the
+ * number of reads as a 64-bit unsigned integer. Every read, in input order,
+ * then takes a 32-bit unsigned integer that holds the cluster ID in the lower
+ * 31 bits and the representative flag in the highest bit. All integers are
+ * little-endian.
+ *
+ * \param fileName Output file name.
+ * \param clusters Cluster assignment of every read.
+ */
+void writeSidecar(string const, ReadClusters const&);
+
+
+/*! Reader for the binary cluster ID files written by `writeSidecar()`.
+ *
+ * The reads are returned in input order, so the file can be read alongside
+ * the original FastQ files.
+ */
+class SidecarReader {
+public:
+  /*! Constructor.
+   *
+   * \param fileName Cluster ID file name.
+   */
+  SidecarReader(string const);
+
+  /*! Get the number of reads.
+   *
+   * \return Number of reads.
+   */
+  size_t size() const;
+
+  /*! Read the cluster assignment of the next read.
+   *
+   * \param cluster Cluster ID, 0 for reads that were filtered.
+   * \param representative Whether the read represents its cluster.
+   *
+   * \return `true` if a read was read, `false` after the last read.
+   */
+  bool read(uint32_t&, bool&);
+
+private:
+  ifstream input_;
+  size_t size_ {0};
+  size_t remaining_ {0};
+  vector<uint8_t> buffer_ {};
+  size_t position_ {0};
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::istream;
+using std::ostream;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+/*! Write a value to a state file.
+ *
+ * \param output State file.
+ * \param value Value.
+ */
+template <class T>
+void writeValue(ostream& output, T const& value) {
+  output.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+/*! Read a value from a state file.
+ *
+ * \param input State file.
+ *
+ * \return Value.
+ */
+template <class T>
+T readValue(istream& input) {
+  T value;
+  if (not input.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw runtime_error("truncated state file");
+  }
+  return value;
+}
+
+/*! Write a vector to a state file.
+ *
+ * \param output State file.
+ * \param data Vector.
+ */
+template <class T>
+void writeVector(ostream& output, vector<T> const& data) {
+  writeValue<uint64_t>(output, data.size());
+  output.write(
+    reinterpret_cast<char const*>(data.data()), data.size() * sizeof(T));
+}
+
+/*! Read a vector from a state file.
+ *
+ * \param input State file.
+ *
+ * \return Vector.
+ */
+template <class T>
+vector<T> readVector(istream& input) {
+  vector<T> data(readValue<uint64_t>(input));
+  if (not input.read(
+      reinterpret_cast<char*>(data.data()), data.size() * sizeof(T))) {
+    throw runtime_error("truncated state file");
+  }
+  return data;
+}
+
+/*! Write a string to a state file.
+ *
+ * \param output State file.
+ * \param data String.
+ */
+inline void writeString(ostream& output, string const& data) {
+  writeVector(output, vector<char>(data.begin(), data.end()));
+}
+
+/*! Read a string from a state file.
+ *
+ * \param input State file.
+ *
+ * \return String.
+ */
+inline string readString(istream& input) {
+  vector<char> data {readVector<char>(input)};
+  return string(data.begin(), data.end());
+}
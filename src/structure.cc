@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#include "structure.h"
+
+using std::invalid_argument;
+using std::istringstream;
+using std::min;
+using std::numeric_limits;
+
+
+/* Get the header, sequence and qualities of a read of either type. */
+void fields_(
+    Read* const read, string_view& name, string_view& sequence,
+    string_view& quality) {
+  name = *read->mName;
+  sequence = *read->mSeq;
+  quality = *read->mQuality;
+}
+
+void fields_(
+    Record const& record, string_view& name, string_view& sequence,
+    string_view& quality) {
+  name = record.name;
+  sequence = record.sequence;
+  quality = record.quality;
+}
+
+
+ReadStructure::ReadStructure(string const spec) {
+  size_t pos {0};
+  while (pos < spec.size()) {
+    Segment_ segment {0, '\0'};
+    if (spec[pos] == '+') {
+      pos++;
+    }
+    else {
+      size_t const start {pos};
+      while (pos < spec.size() and isdigit(spec[pos])) {
+        segment.length = segment.length * 10 + spec[pos++] - '0';
+      }
+      if (pos == start or not segment.length) {
+        throw invalid_argument("invalid read structure: " + spec);
+      }
+    }
+
+    if (
+        pos == spec.size() or
+        (spec[pos] != 'M' and spec[pos] != 'T' and spec[pos] != 'S')) {
+      throw invalid_argument("invalid read structure: " + spec);
+    }
+    segment.type = spec[pos++];
+
+    if (not segment.length and pos != spec.size()) {
+      throw invalid_argument(
+        "only the last segment can have length +: " + spec);
+    }
+    if (not segment.length and segment.type == 'M') {
+      throw invalid_argument("UMI segments need a fixed length: " + spec);
+    }
+    segments_.push_back(segment);
+  }
+
+  if (segments_.empty()) {
+    throw invalid_argument("empty read structure");
+  }
+}
+
+/* Call `f` for every part of `sequence` that lies in a segment of type
+ * `type`.
+ */
+template <class F>
+void ReadStructure::visit_(
+    string_view const sequence, char const type, F const& f) const {
+  size_t pos {0};
+  for (Segment_ const& segment: segments_) {
+    if (pos == sequence.size()) {
+      return;
+    }
+    size_t const length {
+      segment.length ? min(segment.length, sequence.size() - pos)
+        : sequence.size() - pos};
+    if (segment.type == type) {
+      f(sequence.substr(pos, length));
+    }
+    pos += length;
+  }
+}
+
+size_t ReadStructure::umiLength() const {
+  size_t length {0};
+  for (Segment_ const& segment: segments_) {
+    if (segment.type == 'M') {
+      length += segment.length;
+    }
+  }
+  return length;
+}
+
+void ReadStructure::appendUMI(
+    string_view const sequence, string& umi) const {
+  visit_(sequence, 'M', [&umi](string_view const part) {
+    umi += part;
+  });
+}
+
+void ReadStructure::appendTemplate(
+    string_view const sequence, size_t const length, string& text) const {
+  size_t remaining {length};
+  visit_(sequence, 'T', [&text, &remaining](string_view const part) {
+    size_t const taken {min(remaining, part.size())};
+    text += part.substr(0, taken);
+    remaining -= taken;
+  });
+}
+
+size_t ReadStructure::copyUMI(
+    string_view const sequence, size_t const length,
+    char* const destination) const {
+  size_t copied {0};
+  visit_(
+      sequence, 'M', [destination, length, &copied](string_view const part) {
+    copied += part.copy(destination + copied, length - copied);
+  });
+  return copied;
+}
+
+size_t ReadStructure::copyTemplate(
+    string_view const sequence, size_t const length,
+    char* const destination) const {
+  size_t copied {0};
+  visit_(
+      sequence, 'T', [destination, length, &copied](string_view const part) {
+    copied += part.copy(destination + copied, length - copied);
+  });
+  return copied;
+}
+
+
+ReadTrimmer::ReadTrimmer(vector<ReadStructure> const& structures)
+    : structures_ {structures}, buffers_(structures.size()),
+      records_(structures.size()) {}
+
+/* Trim one record of every file. */
+template <class T>
+vector<Record> const& ReadTrimmer::trim_(vector<T> const& reads) {
+  string_view name;
+  string_view sequence;
+  string_view quality;
+
+  umi_.clear();
+  for (size_t i {0}; i < reads.size(); i++) {
+    fields_(reads[i], name, sequence, quality);
+    structures_[i].appendUMI(sequence, umi_);
+  }
+
+  for (size_t i {0}; i < reads.size(); i++) {
+    fields_(reads[i], name, sequence, quality);
+    size_t const end {min(name.find(' '), name.size())};
+
+    string& buffer {buffers_[i]};
+    buffer.assign(name.substr(0, end));
+    if (not umi_.empty()) {
+      buffer += '_';
+      buffer += umi_;
+    }
+    buffer += name.substr(end);
+    buffer += '\n';
+    structures_[i].appendTemplate(
+      sequence, numeric_limits<size_t>::max(), buffer);
+    buffer += "\n+\n";
+    structures_[i].appendTemplate(
+      quality, numeric_limits<size_t>::max(), buffer);
+    buffer += '\n';
+
+    parseRecord(buffer, records_[i], true);
+  }
+
+  return records_;
+}
+
+vector<Record> const& ReadTrimmer::trim(vector<Read*> const& reads) {
+  return trim_(reads);
+}
+
+vector<Record> const& ReadTrimmer::trim(vector<Record> const& reads) {
+  return trim_(reads);
+}
+
+
+vector<ReadStructure> parseStructures(
+    string const specs, size_t const files) {
+  vector<ReadStructure> structures;
+  if (specs.empty()) {
+    return structures;
+  }
+
+  istringstream input(specs);
+  string spec;
+  while (getline(input, spec, ',')) {
+    structures.emplace_back(spec);
+  }
+
+  if (structures.size() != files) {
+    throw invalid_argument(
+      "expected " + std::to_string(files) + " read structures");
+  }
+
+  return structures;
+}
+
+size_t umiLength(vector<ReadStructure> const& structures) {
+  size_t length {0};
+  for (ReadStructure const& structure: structures) {
+    length += structure.umiLength();
+  }
+  return length;
+}
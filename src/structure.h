@@ -0,0 +1,139 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../lib/fastp/src/read.h"
+
+#include "mapped.h"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+/*! Layout of the bases of a read, e.g., `8M+T` for a UMI of eight bases
+ * followed by the template.
+ *
+ * A read structure is a list of segments, each consisting of a length and a
+ * type: `M` for UMI bases, `T` for template bases and `S` for bases that are
+ * skipped. The last segment may have length `+`, meaning the rest of the read.
+ * UMI segments must have a fixed length.
+ */
+class ReadStructure {
+public:
+  /*! Constructor.
+   *
+   * \param spec Read structure, e.g., `8M+T`.
+   */
+  ReadStructure(string const);
+
+  /*! Get the number of UMI bases.
+   *
+   * \return Number of UMI bases.
+   */
+  size_t umiLength() const;
+
+  /*! Append the UMI bases of a sequence to a string. Bases that lie beyond
+   * the end of the sequence are left out.
+   *
+   * \param sequence Sequence.
+   * \param umi String.
+   */
+  void appendUMI(string_view const, string&) const;
+
+  /*! Append at most `length` template bases of a sequence to a string.
+   *
+   * \param sequence Sequence.
+   * \param length Maximum number of bases.
+   * \param text String.
+   */
+  void appendTemplate(string_view const, size_t const, string&) const;
+
+  /*! Copy at most `length` UMI bases of a sequence. Bases that lie beyond
+   * the end of the sequence are left out.
+   *
+   * \param sequence Sequence.
+   * \param length Maximum number of bases.
+   * \param destination Destination, with room for `length` bases.
+   *
+   * \return Number of bases copied.
+   */
+  size_t copyUMI(string_view const, size_t const, char* const) const;
+
+  /*! Copy at most `length` template bases of a sequence.
+   *
+   * \param sequence Sequence.
+   * \param length Maximum number of bases.
+   * \param destination Destination, with room for `length` bases.
+   *
+   * \return Number of bases copied.
+   */
+  size_t copyTemplate(string_view const, size_t const, char* const) const;
+
+private:
+  struct Segment_ {
+    size_t length;  // 0 for the rest of the read.
+    char type;
+  };
+
+  template <class F>
+  void visit_(string_view const, char const, F const&) const;
+
+  vector<Segment_> segments_ {};
+};
+
+
+/*! Read trimming, which removes in-read UMIs and moves them to the header.
+ *
+ * The UMI bases of all files are concatenated and appended to the first
+ * field of the header of every read, after an underscore. The trimmed read
+ * only keeps the template bases and their qualities.
+ */
+class ReadTrimmer {
+public:
+  /*! Constructor.
+   *
+   * \param structures Read structure of every file.
+   */
+  ReadTrimmer(vector<ReadStructure> const&);
+
+  /*! Trim one record of every file.
+   *
+   * \param reads Reads.
+   *
+   * \return Trimmed records, valid until the next call.
+   */
+  vector<Record> const& trim(vector<Read*> const&);
+
+  /*! \copydoc trim */
+  vector<Record> const& trim(vector<Record> const&);
+
+private:
+  template <class T>
+  vector<Record> const& trim_(vector<T> const&);
+
+  vector<ReadStructure> structures_ {};
+  vector<string> buffers_ {};
+  vector<Record> records_ {};
+  string umi_ {};
+};
+
+
+/*! Parse the read structures of all files.
+ *
+ * \param specs Comma separated list of read structures, one for every file.
+ *   If empty, no read structures are used.
+ * \param files Number of files.
+ *
+ * \return Read structure of every file, empty if `specs` is empty.
+ */
+vector<ReadStructure> parseStructures(string const, size_t const);
+
+/*! Determine the total number of UMI bases in multiple files.
+ *
+ * \param structures Read structure of every file.
+ *
+ * \return Number of UMI bases.
+ */
+size_t umiLength(vector<ReadStructure> const&);
@@ -0,0 +1,121 @@
+#include <fstream>
+#include <stdexcept>
+
+#include "whitelist.h"
+
+using std::ifstream;
+using std::invalid_argument;
+
+size_t const maxLength_ {32};
+
+
+/* Pack a word of at most 32 letters into an integer. */
+uint64_t pack_(uint8_t const* const word, size_t const length) {
+  uint64_t packed {0};
+  for (size_t i {0}; i < length; i++) {
+    packed = packed << 2 | word[i];
+  }
+  return packed;
+}
+
+
+Whitelist::Whitelist(string const fileName, size_t const distance)
+    : distance_ {distance} {
+  ifstream input(fileName.c_str());
+  if (not input) {
+    throw invalid_argument("unable to open whitelist " + fileName);
+  }
+
+  string line;
+  while (getline(input, line)) {
+    if (not line.empty() and line.back() == '\r') {
+      line.pop_back();
+    }
+    if (line.empty()) {
+      continue;
+    }
+
+    Word const umi {makeWord(line)};
+    if (umi.filtered) {
+      throw invalid_argument("invalid UMI in whitelist: " + line);
+    }
+    if (not length_) {
+      length_ = umi.data.size();
+      if (length_ > maxLength_) {
+        throw invalid_argument("whitelisted UMIs are longer than 32");
+      }
+    }
+    if (umi.data.size() != length_) {
+      throw invalid_argument("whitelisted UMIs differ in length");
+    }
+
+    uint64_t const packed {pack_(umi.data.data(), length_)};
+    add_(packed, packed, 0, 0);
+  }
+
+  if (not length_) {
+    throw invalid_argument("empty whitelist " + fileName);
+  }
+}
+
+/* Map every sequence within the remaining distance of `sequence` to `umi`.
+ *
+ * \param umi Whitelisted UMI.
+ * \param sequence Sequence.
+ * \param distance Distance between `sequence` and `umi`.
+ * \param position First position that may still be changed.
+ */
+void Whitelist::add_(
+    uint64_t const umi, uint64_t const sequence, size_t const distance,
+    size_t const position) {
+  auto [it, added] {table_.try_emplace(sequence, umi, distance, false)};
+  if (not added) {
+    Entry_& entry {it->second};
+    if (distance < entry.distance) {
+      entry = {umi, distance, false};
+    }
+    else if (distance == entry.distance and umi != entry.umi) {
+      entry.ambiguous = true;
+    }
+  }
+
+  if (distance == distance_) {
+    return;
+  }
+  for (size_t i {position}; i < length_; i++) {
+    size_t const shift {2 * (length_ - i - 1)};
+    uint64_t const letter {sequence >> shift & 3};
+    for (uint64_t other {0}; other < 4; other++) {
+      if (other != letter) {
+        add_(
+          umi, (sequence & ~(uint64_t {3} << shift)) | other << shift,
+          distance + 1, i + 1);
+      }
+    }
+  }
+}
+
+size_t Whitelist::length() const {
+  return length_;
+}
+
+size_t Whitelist::size() const {
+  return table_.size();
+}
+
+void Whitelist::correct(Word& word) const {
+  if (word.filtered) {
+    return;
+  }
+
+  auto const it {table_.find(pack_(word.data.data(), length_))};
+  if (it == table_.end() or it->second.ambiguous) {
+    word.filtered = true;
+    return;
+  }
+
+  uint64_t const umi {it->second.umi};
+  for (size_t i {0}; i < length_; i++) {
+    word.data[i] = umi >> (2 * (length_ - i - 1)) & 3;
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "fastq.h"
+
+using std::string;
+using std::unordered_map;
+
+/*! Known set of UMIs, used to correct the UMI part of words.
+ *
+ * Every sequence within Hamming distance `distance` of a whitelisted UMI is
+ * mapped to that UMI in advance, so a UMI is corrected with a single lookup.
+ * Sequences that are equally close to multiple whitelisted UMIs can not be
+ * corrected.
+ */
+class Whitelist {
+public:
+  /*! Constructor.
+   *
+   * \param fileName Whitelist file name, one UMI per line.
+   * \param distance Maximum number of corrected mismatches.
+   */
+  Whitelist(string const, size_t const);
+
+  /*! Get the UMI length.
+   *
+   * \return UMI length.
+   */
+  size_t length() const;
+
+  /*! Get the number of sequences that can be corrected.
+   *
+   * \return Number of sequences, including the whitelisted UMIs.
+   */
+  size_t size() const;
+
+  /*! Correct the UMI at the start of a word. Words with a UMI that can not be
+   * corrected are filtered.
+   *
+   * \param word Word.
+   */
+  void correct(Word&) const;
+
+private:
+  struct Entry_ {
+    uint64_t umi;
+    size_t distance;
+    bool ambiguous;
+  };
+
+  void add_(uint64_t const, uint64_t const, size_t const, size_t const);
+
+  size_t length_ {0};
+  size_t distance_ {0};
+  unordered_map<uint64_t, Entry_> table_ {};
+};
@@ -0,0 +1,294 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../lib/trie/src/trie.tcc"
+
+#include "../src/cluster.h"
+#include "../src/fastq.h"
+#include "../src/leaf.h"
+#include "../src/output.h"
+#include "../src/pairs.tcc"
+#include "../src/radix.tcc"
+
+using std::atomic;
+using std::bad_alloc;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+using std::mt19937_64;
+using std::string;
+using std::to_string;
+using std::uniform_int_distribution;
+using std::vector;
+
+atomic<size_t> allocations_ {0};
+volatile size_t sink_ {0};  // Keeps results of inlined calls alive.
+
+
+void* operator new(size_t const size) {
+  allocations_++;
+  if (void* const p {malloc(size ? size : 1)}) {
+    return p;
+  }
+  throw bad_alloc();
+}
+
+void operator delete(void* const p) noexcept {
+  free(p);
+}
+
+void operator delete(void* const p, size_t const) noexcept {
+  free(p);
+}
+
+
+/* Time `f` over `n` operations and print the time and number of allocations
+ * per operation.
+ */
+template <class F>
+void benchmark_(string const name, size_t const n, F const& f) {
+  size_t const before {allocations_};
+  steady_clock::time_point const start {steady_clock::now()};
+  for (size_t i {0}; i < n; i++) {
+    f(i);
+  }
+  duration<double, std::nano> const elapsed {steady_clock::now() - start};
+
+  printf(
+    "%-48s %12.1f ns/op %8.2f allocs/op\n", name.c_str(),
+    elapsed.count() / n, static_cast<double>(allocations_ - before) / n);
+}
+
+/* Make random words. */
+vector<vector<uint8_t>> randomWords_(
+    size_t const count, size_t const length, mt19937_64& random) {
+  uniform_int_distribution<int> letter {0, 3};
+  vector<vector<uint8_t>> words(count, vector<uint8_t>(length));
+  for (vector<uint8_t>& word: words) {
+    for (uint8_t& c: word) {
+      c = letter(random);
+    }
+  }
+  return words;
+}
+
+/* Make a random string of nucleotides. */
+string randomSequence_(size_t const length, mt19937_64& random) {
+  uniform_int_distribution<size_t> letter {0, 3};
+  string sequence(length, 'A');
+  for (char& c: sequence) {
+    c = "ACGT"[letter(random)];
+  }
+  return sequence;
+}
+
+/* Make a random neighbour graph. */
+vector<NLeaf> randomGraph_(
+    size_t const leaves, size_t const degree, mt19937_64& random) {
+  uniform_int_distribution<size_t> pick {0, leaves - 1};
+  uniform_int_distribution<size_t> count {1, 100};
+  vector<NLeaf> graph(leaves);
+  for (NLeaf& leaf: graph) {
+    leaf.count = count(random);
+  }
+  for (size_t i {0}; i < leaves * degree / 2; i++) {
+    NLeaf& a {graph[pick(random)]};
+    NLeaf& b {graph[pick(random)]};
+    if (&a != &b) {
+      a.neighbours.push_back(&b);
+      b.neighbours.push_back(&a);
+    }
+  }
+  return graph;
+}
+
+
+void benchmarkWords_(mt19937_64& random) {
+  Read read1 {"@read_ACGTACGT", randomSequence_(150, random), "+", ""};
+  Read read2 {"@read_ACGTACGT", randomSequence_(150, random), "+", ""};
+  vector<Read*> reads {&read1, &read2};
+  string text1 {"@read_ACGTACGT\n" + *read1.mSeq + "\n+\n\n"};
+  string text2 {"@read_ACGTACGT\n" + *read2.mSeq + "\n+\n\n"};
+  vector<Record> records {
+    {{text1.data(), 14}, {text1.data() + 15, 150}, text1},
+    {{text2.data(), 14}, {text2.data() + 15, 150}, text2}};
+
+  for (size_t const n: {16, 24, 32}) {
+    vector<size_t> ntToTake {ntFromFile(2, n - 8)};
+    benchmark_("makeWord/Read/n=" + to_string(n), 1000000, [&](size_t) {
+      makeWord(reads, ntToTake, 8);
+    });
+    benchmark_("makeWord/Record/n=" + to_string(n), 1000000, [&](size_t) {
+      makeWord(records, ntToTake, 8);
+    });
+
+    WordMaker const maker {ntToTake, 8};
+    Word word;
+    benchmark_("WordMaker/Read/n=" + to_string(n), 1000000, [&](size_t) {
+      maker.make(reads, word);
+    });
+    benchmark_("WordMaker/Record/n=" + to_string(n), 1000000, [&](size_t) {
+      maker.make(records, word);
+    });
+
+    // One block per readBlockSize operations, so the time is per read.
+    ReadBlock<Record> const block {
+      vector<vector<Record>>(readBlockSize, records), readBlockSize};
+    vector<Word> words(readBlockSize);
+    benchmark_(
+        "WordMaker/RecordBlock/n=" + to_string(n), 1 << 20,
+        [&](size_t const i) {
+      if (not (i % readBlockSize)) {
+        maker.make(block, words.data());
+      }
+    });
+  }
+
+  benchmark_("extractUMI/Read", 1000000, [&](size_t) {
+    extractUMI(&read1);
+  });
+  benchmark_("extractUMI/Record", 1000000, [&](size_t) {
+    extractUMI(records[0]);
+  });
+  benchmark_("validUMI", 1000000, [&](size_t) {
+    validUMI("ACGTACGT");
+  });
+}
+
+template <class WordStore>
+void benchmarkTrie_(string const name, mt19937_64& random) {
+  for (size_t const n: {16, 24, 32}) {
+    vector<vector<uint8_t>> words {randomWords_(100000, n, random)};
+    string const prefix {name + "/n=" + to_string(n)};
+
+    WordStore trie;
+    benchmark_(prefix + "/add", words.size(), [&](size_t const i) {
+      trie.add(words[i]);
+    });
+    benchmark_(prefix + "/find", words.size(), [&](size_t const i) {
+      sink_ = sink_ + (trie.find(words[i]) != nullptr);
+    });
+
+    for (int const m: {1, 2}) {
+      benchmark_(
+          prefix + "/m=" + to_string(m) + "/asymmetricHamming", 1000,
+          [&](size_t const i) {
+        for (Result<NLeaf> const& result: trie.asymmetricHamming(
+            words[i], m)) {
+          result.leaf->count++;
+        }
+      });
+      benchmark_(
+          prefix + "/m=" + to_string(m) + "/asymmetricLevenshtein", 100,
+          [&](size_t const i) {
+        for (Result<NLeaf> const& result: trie.asymmetricLevenshtein(
+            words[i], m)) {
+          result.leaf->count++;
+        }
+      });
+    }
+  }
+}
+
+void benchmarkPairs_(mt19937_64& random) {
+  for (size_t const n: {16, 24}) {
+    RadixTrie<NLeaf> trie;
+    for (vector<uint8_t> const& word: randomWords_(100000, n, random)) {
+      trie.add(word);
+    }
+    vector<uint8_t> words;
+    for (Result<NLeaf> const& result: trie.walk()) {
+      words.insert(words.end(), result.path.begin(), result.path.end());
+    }
+
+    for (int const m: {1, 2}) {
+      string const prefix {
+        "allPairs/n=" + to_string(n) + "/m=" + to_string(m)};
+      benchmark_(prefix + "/asymmetricHamming", 1, [&](size_t) {
+        for (Result<NLeaf> const& walkResult: trie.walk()) {
+          for (Result<NLeaf> const& result: trie.asymmetricHamming(
+              walkResult.path, m)) {
+            sink_ = sink_ + (result.leaf != walkResult.leaf);
+          }
+        }
+      });
+      benchmark_(prefix + "/hammingPairs", 1, [&](size_t) {
+        hammingPairs(words, n, m, [](uint32_t, uint32_t) {
+          sink_ = sink_ + 1;
+        });
+      });
+    }
+  }
+}
+
+void benchmarkClusters_(mt19937_64& random) {
+  for (size_t const degree: {2, 8}) {
+    vector<NLeaf> graph {randomGraph_(10000, degree, random)};
+    string const suffix {"/leaves=10000/degree=" + to_string(degree)};
+
+    for (bool const maximum: {false, true}) {
+      vector<Cluster*> clusters;
+      benchmark_(
+          (maximum ? "assignMaxCluster" : "assignDirectionalCluster") +
+            suffix,
+          graph.size(), [&](size_t const i) {
+        if (not graph[i].cluster) {
+          Cluster* cluster {new Cluster {clusters.size() + 1}};
+          if (maximum) {
+            assignMaxCluster(&graph[i], cluster);
+          }
+          else {
+            assignDirectionalCluster(&graph[i], cluster);
+          }
+          clusters.push_back(cluster);
+        }
+      });
+
+      freeClusters(clusters);
+      for (NLeaf& leaf: graph) {
+        leaf.cluster = nullptr;
+      }
+    }
+  }
+}
+
+void benchmarkOutput_(mt19937_64& random) {
+  string const sequence {randomSequence_(150, random)};
+  Read read {"@read_ACGTACGT", sequence, "+", string(150, 'I')};
+
+  {
+    Options options;
+    Writer writer {&options, "/dev/null", options.compression};
+    benchmark_("Read::toString+Writer::write", 1000000, [&](size_t) {
+      string const s {read.toString()};
+      writer.write(s.c_str(), s.size());
+    });
+  }
+
+  OutputFile output {"/dev/null"};
+  benchmark_("writeRead/OutputFile", 1000000, [&](size_t) {
+    writeRead(&output, &read);
+  });
+  benchmark_("writeAnnotatedRead/OutputFile", 1000000, [&](size_t i) {
+    writeAnnotatedRead(&output, &read, i);
+  });
+}
+
+
+int main() {
+  mt19937_64 random {0};
+
+  benchmarkWords_(random);
+  benchmarkTrie_<Trie<4, NLeaf>>("Trie", random);
+  benchmarkTrie_<RadixTrie<NLeaf>>("RadixTrie", random);
+  benchmarkPairs_(random);
+  benchmarkClusters_(random);
+  benchmarkOutput_(random);
+
+  return 0;
+}
@@ -0,0 +1,15 @@
+#include <filesystem>
+#include <fstream>
+
+#include "fixtures.h"
+
+using std::filesystem::temp_directory_path;
+using std::ofstream;
+
+
+string writeFile(char const name[], string const content) {
+  string path {temp_directory_path() / name};
+  ofstream output(path, std::ios::binary);
+  output << content;
+  return path;
+}
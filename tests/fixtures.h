@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+using std::string;
+
+/*! Write a file to the temporary directory.
+ *
+ * \param name File name.
+ * \param content File content.
+ *
+ * \return Full path of the file.
+ */
+string writeFile(char const[], string const);
@@ -0,0 +1,74 @@
+#include <catch.hpp>
+
+#include <memory>
+#include <set>
+
+#include "../src/arena.tcc"
+
+using std::set;
+using std::unique_ptr;
+
+
+size_t destroyed_ {0};
+
+/* Object that counts how often it is destroyed. */
+struct Counted_ {
+  ~Counted_() {
+    destroyed_++;
+  }
+
+  size_t value {42};
+};
+
+
+TEST_CASE("Test making objects in an arena", "[arena]") {
+  Arena<uint64_t> arena;
+  REQUIRE(arena.size() == 0);
+  REQUIRE(arena.bytes() == 0);
+
+  // Enough objects for multiple blocks.
+  set<uint64_t*> objects;
+  size_t zeros {0};
+  for (size_t i {0}; i < 100000; i++) {
+    uint64_t* const object {arena.make()};
+    zeros += *object == 0;
+    *object = i;
+    objects.insert(object);
+  }
+  REQUIRE(zeros == 100000);
+  REQUIRE(objects.size() == 100000);
+  REQUIRE(arena.size() == 100000);
+  REQUIRE(arena.bytes() >= 100000 * sizeof(uint64_t));
+
+  size_t sum {0};
+  for (uint64_t* const object: objects) {
+    sum += *object;
+  }
+  REQUIRE(sum == size_t {100000} * 99999 / 2);
+}
+
+TEST_CASE("Test destroying objects in an arena", "[arena]") {
+  destroyed_ = 0;
+  {
+    Arena<Counted_> arena;
+    size_t sum {0};
+    for (size_t i {0}; i < 10000; i++) {
+      sum += arena.make()->value;
+    }
+    REQUIRE(sum == 10000 * 42);
+    REQUIRE(destroyed_ == 0);
+  }
+  REQUIRE(destroyed_ == 10000);
+}
+
+TEST_CASE("Test making many small arenas", "[arena]") {
+  // More arenas than the default limit on memory mappings.
+  vector<unique_ptr<Arena<uint64_t>>> arenas;
+  for (size_t i {0}; i < 70000; i++) {
+    arenas.emplace_back(new Arena<uint64_t>);
+    *arenas.back()->make() = i;
+    *arenas.back()->make() = i;
+  }
+  REQUIRE(arenas.back()->size() == 2);
+  REQUIRE(arenas.back()->bytes() == arenaMinBlock_);
+}
@@ -0,0 +1,89 @@
+#include <catch.hpp>
+
+#include <atomic>
+#include <filesystem>
+
+#include "../src/batch.h"
+#include "fixtures.h"
+
+using std::atomic;
+using std::filesystem::temp_directory_path;
+
+
+TEST_CASE("Test reading a manifest", "[batch]") {
+  string small {writeFile("batch_small.fq", "@r\nA\n+\nI\n")};
+  string large {writeFile("batch_large.fq", "@r\nACGT\n+\nIIII\n")};
+
+  SECTION("Largest sample first") {
+    vector<Sample> samples {readManifest(writeFile(
+      "manifest.tsv",
+      "# name\tdirectory\tfiles\n"
+      "a\tout_a\t" + small + "\n"
+      "\n"
+      "b\tout_b\t" + large + "\t" + small + "\r\n"))};
+    REQUIRE(samples.size() == 2);
+    REQUIRE(samples[0].name == "b");
+    REQUIRE(samples[0].dirName == "out_b");
+    REQUIRE(samples[0].files == vector<string> {large, small});
+    REQUIRE(samples[0].size == 24);
+    REQUIRE(samples[1].name == "a");
+    REQUIRE(samples[1].size == 9);
+  }
+
+  SECTION("Missing files") {
+    REQUIRE_THROWS(readManifest(writeFile("manifest.tsv", "a\tout_a\n")));
+  }
+
+  SECTION("Missing manifest") {
+    REQUIRE_THROWS(readManifest(temp_directory_path() / "missing.tsv"));
+  }
+}
+
+TEST_CASE("Test selecting a sample", "[batch]") {
+  vector<Sample> samples {
+    {"a", "", {}, 30}, {"b", "", {}, 20}, {"c", "", {}, 10}};
+
+  REQUIRE(nextSample(samples, {false, false, false}, 100, false) == 0);
+  REQUIRE(nextSample(samples, {false, false, false}, 25, false) == 1);
+  REQUIRE(nextSample(samples, {false, false, false}, 5, false) == 3);
+  REQUIRE(nextSample(samples, {false, false, false}, 5, true) == 0);
+  REQUIRE(nextSample(samples, {true, false, false}, 15, false) == 2);
+  REQUIRE(nextSample(samples, {true, true, true}, 100, true) == 3);
+}
+
+TEST_CASE("Test running a batch", "[batch]") {
+  vector<Sample> samples {
+    {"a", "", {}, 30}, {"b", "", {}, 20}, {"c", "", {}, 10}, {"d", "", {}, 5}};
+  ofstream log {temp_directory_path() / "batch.log"};
+
+  SECTION("Memory budget") {
+    atomic<size_t> used {0};
+    atomic<size_t> peak {0};
+    atomic<size_t> runs {0};
+    size_t failed {runBatch(samples, 4, 35, [&](Sample const& sample) {
+      size_t now {used += sample.size};
+      size_t p {peak};
+      while (now > p and not peak.compare_exchange_weak(p, now)) {}
+      runs++;
+      used -= sample.size;
+    }, log)};
+    REQUIRE(failed == 0);
+    REQUIRE(runs == 4);
+    REQUIRE(peak <= 35);
+  }
+
+  SECTION("Oversized sample") {
+    size_t runs {0};
+    REQUIRE(runBatch(samples, 2, 1, [&](Sample const&) { runs++; }, log) == 0);
+    REQUIRE(runs == 4);
+  }
+
+  SECTION("Failures") {
+    size_t failed {runBatch(samples, 3, 0, [](Sample const& sample) {
+      if (sample.size < 15) {
+        throw std::runtime_error("failure");
+      }
+    }, log)};
+    REQUIRE(failed == 2);
+  }
+}
@@ -0,0 +1,98 @@
+#include <catch.hpp>
+
+#include "../src/bgzf.h"
+#include "fixtures.h"
+
+// Three BGZF blocks holding two records, the second one split over two
+// blocks, followed by an empty end-of-file block.
+string const bgzf_ {
+  "\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff\x06\x00\x42\x43\x02\x00"
+  "\x2c\x00\x73\x28\x32\x8c\x77\x74\xe6\x72\x74\x76\x0f\xe1\xd2\xe6"
+  "\xf2\x04\x02\x2e\x00\x07\x5d\x53\x90\x13\x00\x00\x00\x1f\x8b\x08"
+  "\x04\x00\x00\x00\x00\x00\xff\x06\x00\x42\x43\x02\x00\x24\x00\x73"
+  "\x28\x32\x8a\x77\x0f\xe1\x0a\x09\x01\x00\xda\x1b\x30\x05\x09\x00"
+  "\x00\x00\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff\x06\x00\x42\x43"
+  "\x02\x00\x23\x00\x73\x77\xe7\xd2\xe6\xf2\x02\x02\x2e\x00\x9f\xf6"
+  "\x5a\xa9\x0a\x00\x00\x00\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff"
+  "\x06\x00\x42\x43\x02\x00\x1b\x00\x03\x00\x00\x00\x00\x00\x00\x00"
+  "\x00\x00", 146};
+
+// Ordinary gzip member holding one record.
+string const gzip_ {
+  "\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\x73\x28\x32\xe6\x72\x74"
+  "\x76\x0f\xe1\xd2\xe6\xf2\x04\x02\x2e\x00\x53\x8d\x78\xc6\x10\x00"
+  "\x00\x00", 34};
+
+
+TEST_CASE("Test determining the size of a BGZF block", "[bgzf]") {
+  REQUIRE(blockSize(bgzf_) == 45);
+  REQUIRE(blockSize(string_view(bgzf_).substr(45)) == 37);
+  REQUIRE(blockSize(string_view(bgzf_).substr(0, 17)) == 0);
+  REQUIRE(blockSize("@read1\nACGT\n+\nIIII\n") == 0);
+}
+
+TEST_CASE("Test detecting BGZF files", "[bgzf]") {
+  REQUIRE(blockCompressed(writeFile("humid_test.bgz", bgzf_)));
+  REQUIRE(not blockCompressed(writeFile("humid_test_plain.fq", "@read1\n")));
+  REQUIRE(not blockCompressed("/nonexistent/humid_test.bgz"));
+
+  // Other members after the BGZF blocks.
+  REQUIRE(not blockCompressed(
+    writeFile("humid_test_appended.gz", bgzf_.substr(0, 118) + gzip_)));
+  REQUIRE(not blockCompressed(writeFile("humid_test_gzip.gz", gzip_)));
+}
+
+TEST_CASE("Test reading a BGZF compressed FastQ file", "[bgzf]") {
+  string path {writeFile("humid_test.bgz", bgzf_)};
+
+  for (size_t threads: {1, 2, 4}) {
+    BlockFastq reader(path.c_str(), threads);
+    Record record;
+
+    REQUIRE(reader.read(record));
+    REQUIRE(record.name == "@r1_AC");
+    REQUIRE(record.sequence == "ACGT");
+
+    REQUIRE(reader.read(record));
+    REQUIRE(record.name == "@r2_GT");
+    REQUIRE(record.sequence == "TTGG");
+    REQUIRE(record.text == "@r2_GT\nTTGG\n+\nJJJJ\n");
+
+    REQUIRE(not reader.read(record));
+  }
+}
+
+TEST_CASE("Test keeping records until they are released", "[bgzf]") {
+  // Repeat the data blocks, so the records span more than one batch.
+  string content;
+  for (size_t i {0}; i < 100; i++) {
+    content += bgzf_.substr(0, 118);
+  }
+  content += bgzf_.substr(118);
+  string path {writeFile("humid_test_batches.bgz", content)};
+
+  BlockFastq reader(path.c_str(), 1);
+  vector<Record> records;
+  Record record;
+  while (reader.read(record)) {
+    records.push_back(record);
+  }
+
+  REQUIRE(records.size() == 200);
+  for (size_t i {0}; i < records.size(); i += 2) {
+    REQUIRE(records[i].text == "@r1_AC\nACGT\n+\nIIII\n");
+    REQUIRE(records[i + 1].text == "@r2_GT\nTTGG\n+\nJJJJ\n");
+  }
+
+  reader.release();
+  REQUIRE(not reader.read(record));
+}
+
+TEST_CASE("Test reading a file with a member that is not BGZF", "[bgzf]") {
+  string path {writeFile(
+    "humid_test_mixed.bgz", bgzf_.substr(0, 118) + gzip_ + bgzf_.substr(118))};
+  REQUIRE(blockCompressed(path));
+
+  // The error names the file.
+  REQUIRE_THROWS_WITH(BlockFastq(path.c_str(), 2), Catch::Contains(path));
+}
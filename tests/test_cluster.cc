@@ -20,6 +20,23 @@ TEST_CASE("Test if a is at least 2x b", "[cluster]") {
   REQUIRE(not atLeastDouble_(3, 2));
 }
 
+TEST_CASE("Test if a leaf can dominate a neighbour", "[cluster]") {
+  NLeaf single;
+  single.count = 1;
+  NLeaf twice;
+  twice.count = 2;
+  NLeaf thrice;
+  thrice.count = 3;
+
+  REQUIRE(not canDominate(&single));
+  REQUIRE(canDominate(&twice));
+
+  REQUIRE(dominates(&twice, &single));
+  REQUIRE(not dominates(&single, &twice));
+  REQUIRE(not dominates(&single, &single));
+  REQUIRE(not dominates(&thrice, &twice));
+}
+
 TEST_CASE("Test walking a node with no neighbours", "[cluster]") {
   // Create a node that is all alone
   NLeaf alone;
@@ -135,3 +152,21 @@ TEST_CASE("Test assigning to cluster", "[cluster]") {
   REQUIRE(cluster1.maxCount == 8);
   REQUIRE(cluster2.maxCount == 10);
 }
+
+TEST_CASE("Test resolving reads to clusters", "[cluster]") {
+  // Reads 1 and 4 were filtered, leaves 1 and 3 form cluster 1, with leaf 3
+  // as its maximum, leaf 2 forms cluster 2.
+  vector<uint32_t> leafIds {1, 0, 2, 3, 0, 3, 2};
+  vector<uint32_t> leafClusters {0, 1, 2, 1};
+  vector<bool> maxLeaves {false, false, true, true};
+
+  ReadClusters reads {
+    resolveReads(std::move(leafIds), leafClusters, maxLeaves)};
+
+  vector<uint32_t> ids {1, 0, 2, 1, 0, 1, 2};
+  REQUIRE(reads.ids == ids);
+
+  // Only the first read of the maximum leaf is a representative.
+  vector<bool> representative {false, false, true, true, false, false, false};
+  REQUIRE(reads.representative == representative);
+}
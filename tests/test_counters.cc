@@ -0,0 +1,83 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <sstream>
+
+#include "../src/counters.h"
+#include "../src/log.h"
+
+using std::filesystem::temp_directory_path;
+using std::ifstream;
+using std::stringstream;
+
+
+TEST_CASE("Test counting stages", "[counters]") {
+  REQUIRE(not stageCounters());
+
+  {
+    StageCounters counters;
+    REQUIRE(stageCounters() == &counters);
+
+    counters.start("Outer");
+    counters.start("Inner");
+    REQUIRE(not counters.stop());
+    StageCounts const* const stage {counters.stop()};
+    REQUIRE(stage);
+    REQUIRE(stage->stage == "Outer");
+    REQUIRE(not counters.stop());
+
+    {
+      StageCounters nested;
+      REQUIRE(stageCounters() == &nested);
+    }
+    REQUIRE(stageCounters() == &counters);
+    REQUIRE(counters.stages().size() == 1);
+  }
+
+  REQUIRE(not stageCounters());
+}
+
+TEST_CASE("Test counting logged stages", "[counters]") {
+  string name {temp_directory_path() / "counters.log"};
+  ofstream log {name};
+
+  StageCounters counters;
+  endMessage(log, startMessage(log, "First stage"));
+  endMessage(log, startMessage(log, "Second stage"));
+  log.close();
+
+  REQUIRE(counters.stages().size() == 2);
+  REQUIRE(counters.stages()[0].stage == "First stage");
+  REQUIRE(counters.stages()[1].stage == "Second stage");
+
+  // Unavailable counters are reported as such.
+  ifstream input {name};
+  stringstream content;
+  content << input.rdbuf();
+  REQUIRE(content.str().starts_with("First stage... done. (0m0s)\n  "));
+}
+
+TEST_CASE("Test writing hardware counts", "[counters]") {
+  string name {temp_directory_path() / "counters.dat"};
+  HardwareCounts counts;
+  counts.values[HardwareCounts::cycles] = 200;
+  counts.values[HardwareCounts::instructions] = 300;
+  counts.values[HardwareCounts::cacheMisses] = 20;
+  counts.available[HardwareCounts::cycles] = true;
+  counts.available[HardwareCounts::instructions] = true;
+  counts.available[HardwareCounts::cacheMisses] = true;
+
+  ofstream output {name};
+  writeCounters(output, {{"Reading data", counts}, {"Writing", {}}}, 10);
+  output.close();
+
+  ifstream input {name};
+  stringstream content;
+  content << input.rdbuf();
+  REQUIRE(content.str() ==
+    "reading_data_cycles: 200\n"
+    "reading_data_instructions: 300\n"
+    "reading_data_cache_misses: 20\n"
+    "reading_data_ipc: 1.5\n"
+    "reading_data_cache_misses_per_read: 2\n");
+}
@@ -0,0 +1,178 @@
+#include <catch.hpp>
+
+#include <random>
+#include <stdexcept>
+#include <sstream>
+
+#include "../src/deduplicator.h"
+
+using std::invalid_argument;
+using std::logic_error;
+using std::mt19937_64;
+using std::runtime_error;
+using std::stringstream;
+using std::uniform_int_distribution;
+
+
+TEST_CASE("Test streaming deduplication", "[deduplicator]") {
+  vector<string> const records {
+    "AAAA", "AAAT", "AAAA", "CCCC", "NAAA", "AAAA"};
+
+  SECTION("Directional clustering") {
+    for (bool const radix: {false, true}) {
+      Deduplicator dedup {makeSegments(0, {4}, "", 1), false, false, radix};
+      for (size_t i {0}; i < records.size(); i++) {
+        REQUIRE(dedup.add(records[i]) == i);
+      }
+      dedup.finalize(true);
+
+      REQUIRE(dedup.reads().ids == vector<uint32_t> {1, 1, 1, 2, 0, 1});
+      REQUIRE(dedup.cluster(3) == 2);
+      REQUIRE(dedup.representative(0));
+      REQUIRE(not dedup.representative(1));
+      REQUIRE(not dedup.representative(2));
+      REQUIRE(dedup.representative(3));
+      REQUIRE(not dedup.representative(4));
+
+      DedupStats const& stats {dedup.stats()};
+      REQUIRE(stats.total == 6);
+      REQUIRE(stats.usable == 5);
+      REQUIRE(stats.unique == 3);
+      REQUIRE(stats.clusters == 2);
+      REQUIRE(stats.counts == map<size_t, size_t> {{1, 2}, {3, 1}});
+      REQUIRE(stats.clusterSizes == map<size_t, size_t> {{1, 1}, {4, 1}});
+      REQUIRE(stats.memory.nodes.objects == (radix ? 5 : 10));
+      REQUIRE(stats.memory.leaves.objects == 3);
+      REQUIRE(stats.memory.neighbours.objects == 2);
+      REQUIRE(stats.memory.clusters.objects == 2);
+      REQUIRE(stats.memory.reads.objects == 6);
+    }
+  }
+
+  SECTION("Maximum clustering") {
+    Deduplicator dedup {makeSegments(0, {4}, "", 1), false, true};
+    for (string const& record: {"AAAA", "AAAT", "AATT", "AATT"}) {
+      dedup.add(record);
+    }
+    dedup.finalize();
+    REQUIRE(dedup.reads().ids == vector<uint32_t> {1, 1, 1, 1});
+    REQUIRE(dedup.representative(2));
+  }
+
+  SECTION("Low complexity") {
+    Deduplicator dedup {
+      makeSegments(0, {4}, "", 1), false, false, false, 1, 70};
+    for (string const& record: {"GGGG", "AAAC", "GGGT", "ACGT", "GGGG"}) {
+      dedup.add(record);
+    }
+    dedup.finalize(true);
+    REQUIRE(dedup.reads().ids == vector<uint32_t> {0, 0, 0, 1, 0});
+    REQUIRE(dedup.stats().usable == 5);
+    REQUIRE(dedup.stats().lowComplexity == 4);
+    REQUIRE(dedup.stats().unique == 1);
+  }
+
+  SECTION("Batches") {
+    for (size_t const threads: {1, 4}) {
+      for (bool const radix: {false, true}) {
+        Deduplicator dedup {
+          makeSegments(0, {4}, "", 1), false, false, radix, threads};
+        vector<Word> words;
+        for (string const& record: records) {
+          words.push_back(makeWord(record));
+        }
+        REQUIRE(dedup.add(words) == 0);
+        REQUIRE(dedup.add(vector<Word> {makeWord("CCCA")}) == 6);
+        dedup.finalize(true);
+
+        REQUIRE(dedup.reads().ids == vector<uint32_t> {1, 1, 1, 3, 0, 1, 2});
+        REQUIRE(dedup.stats().total == 7);
+        REQUIRE(dedup.stats().usable == 6);
+        REQUIRE(dedup.stats().unique == 4);
+      }
+    }
+  }
+
+  SECTION("Misuse") {
+    Deduplicator dedup {makeSegments(0, {4}, "", 1)};
+    REQUIRE_THROWS(dedup.add("AAA"));
+    REQUIRE_THROWS(dedup.add(vector<Word> {makeWord("AAAA"), makeWord("A")}));
+    REQUIRE(dedup.stats().total == 0);
+    dedup.add("AAAA");
+    dedup.finalize();
+    REQUIRE_THROWS(dedup.add("AAAA"));
+    REQUIRE_THROWS(dedup.finalize());
+  }
+
+  SECTION("Edit distance with budgets per segment") {
+    REQUIRE_THROWS_AS(
+      Deduplicator(makeSegments(0, {2, 2}, "1,1", 0), true),
+      invalid_argument);
+
+    // Segments that must match exactly are allowed.
+    Deduplicator dedup {makeSegments(0, {2, 2}, "0,1", 0), true};
+    for (string const record: {"AAAA", "AAAA", "AAAG", "CAAA"}) {
+      dedup.add(record);
+    }
+    dedup.finalize();
+    REQUIRE(dedup.stats().clusters == 2);
+  }
+}
+
+TEST_CASE("Test incremental deduplication", "[deduplicator]") {
+  mt19937_64 random {0};
+  uniform_int_distribution<int> letter {0, 3};
+  vector<string> records(400, string(6, 'A'));
+  for (string& record: records) {
+    // Few distinct letters in the first positions make many neighbours.
+    for (size_t i {0}; i < record.size(); i++) {
+      record[i] = "ACGT"[letter(random) >> (i < 3)];
+    }
+  }
+
+  SECTION("Split run") {
+    for (bool const edit: {false, true}) {
+      for (bool const maximum: {false, true}) {
+        for (bool const radix: {false, true}) {
+          // A larger distance finds words along more edit paths.
+          Segments const segments {makeSegments(0, {6}, "", 1 + edit)};
+          Deduplicator full {segments, edit, maximum, radix};
+          for (string const& record: records) {
+            full.add(record);
+          }
+          full.finalize(true);
+
+          stringstream state;
+          ofstream log;
+          Deduplicator first {segments, edit, maximum, radix};
+          for (size_t i {0}; i < records.size() / 2; i++) {
+            first.add(records[i]);
+          }
+          first.finalize(false, log, &state);
+
+          Deduplicator second {segments, edit, maximum, radix};
+          second.load(state);
+          for (size_t i {records.size() / 2}; i < records.size(); i++) {
+            second.add(records[i]);
+          }
+          second.finalize(true);
+
+          REQUIRE(second.reads().ids == full.reads().ids);
+          REQUIRE(
+            second.reads().representative == full.reads().representative);
+          REQUIRE(second.stats().total == records.size());
+          REQUIRE(second.stats().unique == full.stats().unique);
+          REQUIRE(second.stats().clusters == full.stats().clusters);
+        }
+      }
+    }
+  }
+
+  SECTION("Misuse") {
+    stringstream state;
+    Deduplicator dedup {makeSegments(0, {4}, "", 1)};
+    REQUIRE_THROWS_AS(dedup.load(state), runtime_error);
+    dedup.add("AAAA");
+    REQUIRE_THROWS_AS(dedup.load(state), logic_error);
+  }
+}
@@ -0,0 +1,34 @@
+#include <catch.hpp>
+
+#include "../src/estimate.h"
+
+
+TEST_CASE("Test extrapolation", "[estimate]") {
+  SECTION("Without extrapolation") {
+    Estimate estimate {extrapolate({{1, 10}, {2, 5}}, 20, 20)};
+    REQUIRE(estimate.value == 15);
+    REQUIRE(estimate.lower == 15);
+    REQUIRE(estimate.upper == 15);
+  }
+
+  SECTION("Without singletons") {
+    Estimate estimate {extrapolate({{2, 5}, {3, 1}}, 13, 1000)};
+    REQUIRE(estimate.value == 6);
+    REQUIRE(estimate.upper == 6);
+  }
+
+  SECTION("With singletons") {
+    Estimate estimate {extrapolate({{1, 10}, {2, 5}, {3, 5}}, 35, 70)};
+    REQUIRE(estimate.value == Approx(26.1923));
+    REQUIRE(estimate.lower > 20);
+    REQUIRE(estimate.lower < estimate.value);
+    REQUIRE(estimate.upper > estimate.value);
+  }
+
+  SECTION("Only singletons") {
+    Estimate estimate {extrapolate({{1, 10}}, 10, 100)};
+    REQUIRE(estimate.value > 10);
+    REQUIRE(estimate.lower <= estimate.value);
+    REQUIRE(estimate.upper >= estimate.value);
+  }
+}
@@ -1,6 +1,15 @@
 #include <catch.hpp>
 
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
 #include "../src/fastq.h"
+#include "fixtures.h"
+
+using std::filesystem::temp_directory_path;
+using std::ifstream;
+using std::stringstream;
 
 string extractUMI_(string);
 string makeStringSize_(string, size_t, char);
@@ -45,6 +54,55 @@ TEST_CASE("Extract UMI from header") {
   }
 }
 
+TEST_CASE("Extract cell barcode from header", "[fastq]") {
+  Read underscore("header_GGCC_AATT with spaces", "", "", "");
+  REQUIRE(extractBarcode(&underscore) == "GGCC");
+
+  Read colon("Instrument:RunID:Lane:Tile:X:Y:GGCC:ATCG", "", "", "");
+  REQUIRE(extractBarcode(&colon) == "GGCC");
+
+  Record record {"header_GGCCA_AATT", "", ""};
+  REQUIRE(extractBarcode(record) == "GGCCA");
+
+  // No barcode, or a barcode without a UMI.
+  Read noBarcode("header_AATT", "", "", "");
+  REQUIRE(extractBarcode(&noBarcode) == "");
+  Read noUMI("header_GGCC_aatt", "", "", "");
+  REQUIRE(extractBarcode(&noUMI) == "");
+  Read BCL("Instrument:RunID:FlowCellID:Lane:Tile:X:Y:ATCG", "", "", "");
+  REQUIRE(extractBarcode(&BCL) == "");
+}
+
+TEST_CASE("Test appending the cell barcode to a word", "[fastq]") {
+  Read read1("header_GGCC_AATT", "ACGTACGTACGTACGTACGT", "", "");
+  Read read2("header_GG_AATT", "ACGTACGTACGTACGTACGT", "", "");
+  Read read3("header_GGCCA_AATT", "ACGTACGTACGTACGTACGT", "", "");
+  vector<Read*> complete {&read1};
+  vector<Read*> partial {&read2};
+  vector<Read*> longer {&read3};
+
+  for (size_t const length: {20, 24}) {
+    WordMaker const maker {{length - 4}, 4, nullptr, 4};
+    vector<uint8_t> expected {makeWord(complete, {length - 4}, 4).data};
+    expected.insert(expected.end(), {2, 2, 1, 1});
+
+    Word word;
+    maker.make(complete, word);
+    REQUIRE(word.data == expected);
+    REQUIRE(not word.filtered);
+
+    // A barcode that is too short is padded, and the word is filtered.
+    maker.make(partial, word);
+    REQUIRE(word.data.size() == length + 4);
+    REQUIRE(word.filtered);
+
+    // A barcode that is too long is not cut to its prefix.
+    maker.make(longer, word);
+    REQUIRE(word.data.size() == length + 4);
+    REQUIRE(word.filtered);
+  }
+}
+
 TEST_CASE("Test making a Word out of a vector of Reads") {
   Read read1("header", "AAAA", "", "");
   Read read2("header2", "TTTT", "", "");
@@ -200,3 +258,131 @@ TEST_CASE("Test making a string a given size") {
   REQUIRE(makeStringSize_("AA", 2, 'N') == "AA");
   REQUIRE(makeStringSize_("AA", 3, 'N') == "AAN");
 }
+
+TEST_CASE("Test writing reads", "[fastq]") {
+  string name {temp_directory_path() / "reads.fq"};
+  Read read("@header", "ACGT", "+", "IIII");
+  Record record {"@other", "AC", "@other\nAC\n+\nII"};
+
+  {
+    OutputFile output {name};
+    writeRead(&output, &read);
+    writeAnnotatedRead(&output, &read, 12);
+    writeRead(&output, record);
+    writeAnnotatedRead(&output, record, 3);
+  }
+
+  ifstream input {name};
+  stringstream content;
+  content << input.rdbuf();
+  REQUIRE(content.str() ==
+    "@header\nACGT\n+\nIIII\n"
+    "@header:12\nACGT\n+\nIIII\n"
+    "@other\nAC\n+\nII\n"
+    "@other:3\nAC\n+\nII\n");
+}
+
+TEST_CASE("Test detecting low complexity words", "[fastq]") {
+  REQUIRE(lowComplexity({2, 2, 2, 2, 2, 2, 2, 2, 2, 0}, 80));
+  REQUIRE(not lowComplexity({2, 2, 2, 2, 2, 2, 2, 2, 2, 0}, 90));
+  REQUIRE(not lowComplexity({0, 1, 2, 3, 0, 1, 2, 3}, 30));
+  REQUIRE(lowComplexity({0, 1, 2, 3, 0, 1, 2, 3}, 20));
+}
+
+TEST_CASE("Test specialised word extraction", "[fastq]") {
+  Read read1("header_ACGTACGT", "ACGTACGTACGTACGTACGTACGTACGTACGT", "", "");
+  Read read2("header2", "TTGGCCAA", "", "");
+  Read read3("header3", "GATTACANGATTACAGATTACA", "", "");
+  Read read4("header4", "CCCCGGGGAAAATTTTCCCCGGGGAAAATTTT", "", "");
+  vector<Read*> allReads {&read1, &read2, &read3, &read4};
+
+  for (size_t const files: {1, 2, 3, 4}) {
+    vector<Read*> reads(allReads.begin(), allReads.begin() + files);
+    vector<string> texts;
+    for (Read* const read: reads) {
+      texts.push_back(*read->mName + "\n" + *read->mSeq + "\n+\n\n");
+    }
+    vector<Record> records;
+    for (size_t i {0}; i < files; i++) {
+      records.push_back({
+        {texts[i].data(), reads[i]->mName->size()},
+        {texts[i].data() + reads[i]->mName->size() + 1,
+          reads[i]->mSeq->size()},
+        texts[i]});
+    }
+
+    for (size_t const length: {20, 24, 32}) {
+      for (size_t const header: {0, 8}) {
+        vector<size_t> const ntToTake {ntFromFile(files, length - header)};
+        WordMaker const maker {ntToTake, header};
+        REQUIRE(
+          maker.specialised() ==
+          (files < 4 and (length == 24 or length == 32)));
+
+        Word const expected {makeWord(reads, ntToTake, header)};
+        Word word {{1, 2, 3}, true};
+        maker.make(reads, word);
+        REQUIRE(word.data == expected.data);
+        REQUIRE(word.filtered == expected.filtered);
+        maker.make(records, word);
+        REQUIRE(word.data == expected.data);
+        REQUIRE(word.filtered == expected.filtered);
+      }
+    }
+  }
+}
+
+TEST_CASE("Test reading blocks of reads", "[fastq]") {
+  vector<string> const files {
+    writeFile(
+      "humid_test_block1.fastq",
+      "@r1_AC\nAAAA\n+\nIIII\n@r2_CG\nCCCC\n+\nIIII\n"
+      "@r3_GT\nGGGG\n+\nIIII\n"),
+    writeFile(
+      "humid_test_block2.fastq",
+      "@r1\nTTTT\n+\nIIII\n@r2\nGGGG\n+\nIIII\n@r3\nCCCC\n+\nIIII\n")};
+  vector<string> const sequences {"AAAA", "CCCC", "GGGG"};
+
+  vector<size_t> sizes;
+  size_t ordinal {0};
+  for (ReadBlock<Record> const& block: readRecords(files, 1, 2)) {
+    sizes.push_back(block.size);
+    for (size_t i {0}; i < block.size; i++) {
+      REQUIRE(block.reads[i].size() == 2);
+      REQUIRE(block.reads[i][0].sequence == sequences[ordinal++]);
+    }
+  }
+  REQUIRE(sizes == vector<size_t> {2, 1});
+
+  sizes.clear();
+  ordinal = 0;
+  for (ReadBlock<Read*> const& block: readFiles(files, 2)) {
+    sizes.push_back(block.size);
+    for (size_t i {0}; i < block.size; i++) {
+      REQUIRE(block.reads[i].size() == 2);
+      REQUIRE(*block.reads[i][0]->mSeq == sequences[ordinal++]);
+    }
+  }
+  REQUIRE(sizes == vector<size_t> {2, 1});
+}
+
+TEST_CASE("Test making the words of a block of reads", "[fastq]") {
+  vector<string> const files {writeFile(
+    "humid_test_block.fastq",
+    "@r1_AC\nAAAAAAAAAAAAAAAAAAAAAA\n+\n\n@r2_CG\nCCCCNC\n+\n\n"
+    "@r3_GT\nGGGGGGGGGGGGGGGGGGGGGG\n+\n\n")};
+
+  for (size_t const length: {20, 24}) {
+    WordMaker const maker {{length - 2}, 2};
+    vector<Word> words(readBlockSize);
+    for (ReadBlock<Record> const& block: readRecords(files, 1)) {
+      REQUIRE(block.size == 3);
+      maker.make(block, words.data());
+      for (size_t i {0}; i < block.size; i++) {
+        Word const expected {makeWord(block.reads[i], {length - 2}, 2)};
+        REQUIRE(words[i].data == expected.data);
+        REQUIRE(words[i].filtered == expected.filtered);
+      }
+    }
+  }
+}
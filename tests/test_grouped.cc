@@ -0,0 +1,117 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "../src/grouped.h"
+
+using std::filesystem::create_directories;
+using std::filesystem::directory_iterator;
+using std::filesystem::remove_all;
+using std::filesystem::temp_directory_path;
+using std::ifstream;
+using std::stringstream;
+using std::to_string;
+
+
+/* Add reads with a given cluster assignment, and write them grouped. */
+string group_(
+    ClusterSorter& sorter, string const dirName,
+    vector<uint32_t> const& clusters,
+    vector<bool> const& representatives) {
+  for (size_t i {0}; i < clusters.size(); i++) {
+    sorter.add(
+      clusters[i], representatives[i],
+      {"@" + to_string(i) + ':' + to_string(clusters[i]) + '\n'});
+  }
+
+  string const name {dirName + "/grouped.txt"};
+  {
+    OutputFile output {name};
+    sorter.write({&output});
+  }
+
+  ifstream input {name};
+  stringstream content;
+  content << input.rdbuf();
+  return content.str();
+}
+
+
+TEST_CASE("Test grouping reads by cluster", "[grouped]") {
+  string const dirName {temp_directory_path() / "humid_grouped"};
+  create_directories(dirName);
+
+  vector<uint32_t> const clusters {3, 1, 0, 2, 1, 3, 0, 2, 1};
+  vector<bool> const representatives {
+    false, false, false, true, true, true, false, false, false};
+  string const expected {
+    "@4:1\n@1:1\n@8:1\n@3:2\n@7:2\n@5:3\n@0:3\n@2:0\n@6:0\n"};
+
+  SECTION("In memory") {
+    ClusterSorter sorter {dirName};
+    REQUIRE(group_(sorter, dirName, clusters, representatives) == expected);
+    REQUIRE(sorter.runs() == 0);
+  }
+
+  SECTION("Single merge") {
+    ClusterSorter sorter {dirName, 1};
+    REQUIRE(group_(sorter, dirName, clusters, representatives) == expected);
+    REQUIRE(sorter.runs() == clusters.size());
+  }
+
+  SECTION("Multiple merge passes") {
+    ClusterSorter sorter {dirName, 1, 2};
+    REQUIRE(group_(sorter, dirName, clusters, representatives) == expected);
+    REQUIRE(sorter.runs() == clusters.size());
+  }
+
+  // Only the output is left.
+  size_t files {0};
+  for (auto const& entry: directory_iterator(dirName)) {
+    REQUIRE(entry.path().filename() == "grouped.txt");
+    files++;
+  }
+  REQUIRE(files == 1);
+
+  remove_all(dirName);
+}
+
+TEST_CASE("Test grouping reads from multiple files", "[grouped]") {
+  string const dirName {temp_directory_path() / "humid_grouped_pairs"};
+  create_directories(dirName);
+
+  ClusterSorter sorter {dirName, 1, 3};
+  for (uint32_t i {0}; i < 100; i++) {
+    sorter.add(
+      i % 10 + 1, i < 10,
+      {"@" + to_string(i) + "/1\n", "@" + to_string(i) + "/2\n"});
+  }
+
+  string const name1 {dirName + "/grouped_1.txt"};
+  string const name2 {dirName + "/grouped_2.txt"};
+  {
+    OutputFile output1 {name1};
+    OutputFile output2 {name2};
+    sorter.write({&output1, &output2});
+  }
+
+  ifstream input1 {name1};
+  ifstream input2 {name2};
+  string line1;
+  string line2;
+  size_t ordinal {0};
+  while (getline(input1, line1)) {
+    REQUIRE(getline(input2, line2));
+
+    // Every cluster starts with its representative.
+    size_t const expected {ordinal % 10 * 10 + ordinal / 10};
+    REQUIRE(line1 == "@" + to_string(expected) + "/1");
+    REQUIRE(line2 == "@" + to_string(expected) + "/2");
+    ordinal++;
+  }
+  REQUIRE(ordinal == 100);
+
+  remove_all(dirName);
+}
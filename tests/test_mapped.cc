@@ -0,0 +1,71 @@
+#include <catch.hpp>
+
+#include "../src/fastq.h"
+#include "../src/mapped.h"
+#include "fixtures.h"
+
+
+TEST_CASE("Test reading a memory mapped FastQ file", "[mapped]") {
+  string path {writeFile(
+    "humid_test.fastq",
+    "@read1_AATT\nACGT\n+\nIIII\n@read2_CCGG\nTTTT\n+\nJJJJ")};
+
+  MappedFastq reader(path.c_str());
+  Record record;
+
+  REQUIRE(reader.read(record));
+  REQUIRE(record.name == "@read1_AATT");
+  REQUIRE(record.sequence == "ACGT");
+  REQUIRE(record.text == "@read1_AATT\nACGT\n+\nIIII\n");
+  REQUIRE(record.quality == "IIII");
+  REQUIRE(extractUMI(record) == "AATT");
+
+  // The last record has no line ending.
+  REQUIRE(reader.read(record));
+  REQUIRE(record.name == "@read2_CCGG");
+  REQUIRE(record.sequence == "TTTT");
+  REQUIRE(record.text == "@read2_CCGG\nTTTT\n+\nJJJJ");
+
+  REQUIRE(not reader.read(record));
+}
+
+TEST_CASE("Test reading an empty memory mapped file", "[mapped]") {
+  string path {writeFile("humid_test_empty.fastq", "")};
+
+  MappedFastq reader(path.c_str());
+  Record record;
+
+  REQUIRE(not reader.read(record));
+}
+
+TEST_CASE("Test stripping carriage returns", "[mapped]") {
+  string path {writeFile(
+    "humid_test_crlf.fastq", "@read1\r\nACGT\r\n+\r\nIIII\r\n")};
+
+  MappedFastq reader(path.c_str());
+  Record record;
+
+  REQUIRE(reader.read(record));
+  REQUIRE(record.name == "@read1");
+  REQUIRE(record.sequence == "ACGT");
+}
+
+TEST_CASE("Test detecting mappable files", "[mapped]") {
+  REQUIRE(mappable(writeFile("humid_test_plain.fastq", "@read1\n")));
+  REQUIRE(not mappable(writeFile("humid_test.fastq.gz", "\x1f\x8b\x08")));
+  REQUIRE(not mappable("/nonexistent/humid_test.fastq"));
+}
+
+TEST_CASE("Test making a Word out of a vector of Records", "[mapped]") {
+  Read read1("header_AC", "AAAA", "", "");
+  Read read2("header2", "TTTT", "", "");
+  vector<Read*> reads {&read1, &read2};
+
+  Record record1 {"header_AC", "AAAA", ""};
+  Record record2 {"header2", "TTTT", ""};
+  vector<Record> records {record1, record2};
+
+  REQUIRE(makeWord(records, {4, 4}, 2).data == makeWord(reads, {4, 4}, 2).data);
+  REQUIRE(makeWord(records, {5, 3}, 3).data == makeWord(reads, {5, 3}, 3).data);
+  REQUIRE(makeWord(records, {5, 3}, 3).filtered);
+}
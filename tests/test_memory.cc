@@ -0,0 +1,39 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <sstream>
+
+#include "../src/memory.h"
+
+using std::filesystem::temp_directory_path;
+using std::ifstream;
+using std::string;
+using std::stringstream;
+
+
+TEST_CASE("Test peak RSS", "[memory]") {
+  size_t const before {peakRSS()};
+  REQUIRE(before > 0);
+
+  string data(before + (64 << 20), 'A');
+  REQUIRE(peakRSS() > before);
+}
+
+TEST_CASE("Test writing memory usage", "[memory]") {
+  string name {temp_directory_path() / "memory.dat"};
+  MemoryUsage memory {{10, 640}, {3, 96}, {}, {2, 48}, {6, 24}};
+
+  ofstream output {name};
+  writeMemory(output, memory);
+  output.close();
+
+  ifstream input {name};
+  stringstream content;
+  content << input.rdbuf();
+  REQUIRE(content.str() ==
+    "nodes_count: 10\nnodes_bytes: 640\n"
+    "leaves_count: 3\nleaves_bytes: 96\n"
+    "neighbours_count: 0\nneighbours_bytes: 0\n"
+    "clusters_count: 2\nclusters_bytes: 48\n"
+    "reads_count: 6\nreads_bytes: 24\n");
+}
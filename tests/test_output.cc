@@ -0,0 +1,56 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "../src/output.h"
+
+using std::filesystem::temp_directory_path;
+using std::ifstream;
+using std::stringstream;
+
+
+/* Read a file into a string. */
+string slurp_(string const name) {
+  ifstream input {name};
+  stringstream content;
+  content << input.rdbuf();
+  return content.str();
+}
+
+
+TEST_CASE("Test writing buffered output", "[output]") {
+  string name {temp_directory_path() / "output.txt"};
+  string expected;
+
+  SECTION("Many small buffers") {
+    {
+      OutputFile output {name, 8, 2};
+      for (size_t i {0}; i < 1000; i++) {
+        string line {"line " + std::to_string(i)};
+        output.write(line);
+        output.put('\n');
+        expected += line + '\n';
+      }
+    }
+    REQUIRE(slurp_(name) == expected);
+  }
+
+  SECTION("Data larger than a buffer") {
+    expected = string(100, 'A');
+    {
+      OutputFile output {name, 8, 2};
+      output.put('@');
+      output.write(expected);
+    }
+    REQUIRE(slurp_(name) == '@' + expected);
+  }
+
+  SECTION("Empty file") {
+    {
+      OutputFile output {name};
+    }
+    REQUIRE(slurp_(name).empty());
+  }
+}
@@ -0,0 +1,86 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include "../src/pairs.tcc"
+
+using std::is_sorted;
+using std::mt19937;
+using std::pair;
+using std::set;
+
+
+/* Collect all pairs, in lexicographic order. */
+vector<pair<uint32_t, uint32_t>> pairs_(
+    vector<uint8_t> const& words, size_t const length,
+    size_t const distance) {
+  vector<pair<uint32_t, uint32_t>> pairs;
+  hammingPairs(words, length, distance, [&](uint32_t i, uint32_t j) {
+    pairs.push_back({i, j});
+  });
+  sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+
+TEST_CASE("Test finding pairs in a small set of words", "[pairs]") {
+  vector<uint8_t> const words {
+    0, 0, 0,
+    0, 0, 1,
+    0, 1, 1,
+    3, 0, 1};
+
+  REQUIRE(pairs_(words, 3, 0).empty());
+  REQUIRE(
+    pairs_(words, 3, 1) ==
+    vector<pair<uint32_t, uint32_t>> {{0, 1}, {1, 2}, {1, 3}});
+  REQUIRE(pairs_(words, 3, 3).size() == 6);
+  REQUIRE(pairs_({}, 3, 1).empty());
+}
+
+TEST_CASE("Test finding pairs in random words", "[pairs]") {
+  mt19937 generator(4);
+  set<vector<uint8_t>> unique;
+  while (unique.size() < 400) {
+    vector<uint8_t> word(8);
+    for (size_t i {0}; i < word.size(); i++) {
+      word[i] = generator() % (i < 4 ? 2 : 4);
+    }
+    unique.insert(word);
+  }
+
+  vector<uint8_t> words;
+  vector<vector<uint8_t>> sorted(unique.begin(), unique.end());
+  for (vector<uint8_t> const& word: sorted) {
+    words.insert(words.end(), word.begin(), word.end());
+  }
+
+  for (size_t const distance: {0, 1, 2, 3}) {
+    vector<pair<uint32_t, uint32_t>> expected;
+    for (uint32_t i {0}; i < sorted.size(); i++) {
+      for (uint32_t j {i + 1}; j < sorted.size(); j++) {
+        size_t mismatches {0};
+        for (size_t k {0}; k < 8; k++) {
+          mismatches += sorted[i][k] != sorted[j][k];
+        }
+        if (mismatches <= distance) {
+          expected.push_back({i, j});
+        }
+      }
+    }
+
+    REQUIRE(pairs_(words, 8, distance) == expected);
+
+    // Linking the pairs as they are visited gives sorted neighbour lists.
+    vector<vector<uint32_t>> neighbours(sorted.size());
+    hammingPairs(words, 8, distance, [&](uint32_t i, uint32_t j) {
+      neighbours[i].push_back(j);
+      neighbours[j].push_back(i);
+    });
+    for (vector<uint32_t> const& list: neighbours) {
+      REQUIRE(is_sorted(list.begin(), list.end()));
+    }
+  }
+}
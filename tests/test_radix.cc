@@ -0,0 +1,160 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include "../src/radix.tcc"
+
+using std::mt19937;
+using std::sort;
+
+
+// Helper function to make random words.
+vector<vector<uint8_t>> randomWords(
+    size_t const number, size_t const length, unsigned int const seed) {
+  mt19937 generator(seed);
+  vector<vector<uint8_t>> words;
+  for (size_t i {0}; i < number; i++) {
+    vector<uint8_t> word;
+    for (size_t j {0}; j < length; j++) {
+      word.push_back(generator() % (i % 3 ? 4 : 2));
+    }
+    words.push_back(word);
+  }
+  return words;
+}
+
+// Helper function to collect sorted search results.
+vector<vector<uint8_t>> paths(generator<Result<Leaf>> results) {
+  vector<vector<uint8_t>> found;
+  for (Result<Leaf> const& result: results) {
+    found.push_back(result.path);
+  }
+  sort(found.begin(), found.end());
+  return found;
+}
+
+// Helper function to calculate the Levenshtein distance.
+size_t editDistance(vector<uint8_t> const& a, vector<uint8_t> const& b) {
+  vector<size_t> row(b.size() + 1);
+  for (size_t j {0}; j < row.size(); j++) {
+    row[j] = j;
+  }
+  for (size_t i {1}; i <= a.size(); i++) {
+    vector<size_t> previous {row};
+    row[0] = i;
+    for (size_t j {1}; j <= b.size(); j++) {
+      row[j] = std::min({
+        previous[j] + 1, row[j - 1] + 1,
+        previous[j - 1] + (a[i - 1] != b[j - 1])});
+    }
+  }
+  return row.back();
+}
+
+// Helper function to calculate the Hamming distance.
+size_t hammingDistance(vector<uint8_t> const& a, vector<uint8_t> const& b) {
+  size_t distance {0};
+  for (size_t i {0}; i < a.size(); i++) {
+    distance += a[i] != b[i];
+  }
+  return distance;
+}
+
+
+TEST_CASE("Test adding and finding words in a radix trie", "[radix]") {
+  RadixTrie<> radix;
+
+  radix.add({0, 1, 2, 3});
+  radix.add({0, 1, 2, 3});
+  radix.add({0, 1, 3, 3});
+
+  REQUIRE(radix.find({0, 1, 2, 3})->leaf->count == 2);
+  REQUIRE(radix.find({0, 1, 3, 3})->leaf->count == 1);
+  REQUIRE(not radix.find({0, 1, 2}));
+  REQUIRE(not radix.find({0, 1, 2, 2}));
+  REQUIRE(not radix.find({0, 1, 2, 3, 0}));
+
+  // The shared prefix is split into its own node.
+  RadixNode<Leaf>* node {radix.find({0, 1, 3, 3})};
+  REQUIRE(node->length == 2);
+}
+
+TEST_CASE("Test adding words longer than one label", "[radix]") {
+  RadixTrie<> radix;
+  vector<uint8_t> word(70, 1);
+  word.back() = 2;
+
+  radix.add(word);
+  REQUIRE(radix.find(word)->leaf->count == 1);
+  REQUIRE(radix.find(word)->length == 6);
+  REQUIRE(radix.nodes() == 4);
+
+  word[40] = 3;
+  REQUIRE(not radix.find(word));
+}
+
+TEST_CASE("Test walking a radix trie", "[radix]") {
+  RadixTrie<> radix;
+  Trie<4, Leaf> trie;
+  for (vector<uint8_t> const& word: randomWords(500, 24, 1)) {
+    radix.add(word);
+    trie.add(word);
+  }
+
+  vector<vector<uint8_t>> expected;
+  for (Result<Leaf> const& result: trie.walk()) {
+    expected.push_back(result.path);
+    REQUIRE(radix.find(result.path)->leaf->count == result.leaf->count);
+  }
+
+  // The walk is in lexicographic order.
+  vector<vector<uint8_t>> found;
+  for (Result<Leaf> const& result: radix.walk()) {
+    found.push_back(result.path);
+  }
+  REQUIRE(found == expected);
+}
+
+TEST_CASE("Test finding neighbours in a radix trie", "[radix]") {
+  vector<vector<uint8_t>> words {randomWords(300, 12, 2)};
+  RadixTrie<> radix;
+  for (vector<uint8_t> const& word: words) {
+    radix.add(word);
+  }
+
+  vector<vector<uint8_t>> unique;
+  for (Result<Leaf> const& result: radix.walk()) {
+    unique.push_back(result.path);
+  }
+
+  for (int distance: {0, 1, 2}) {
+    for (vector<uint8_t> const& word: unique) {
+      vector<vector<uint8_t>> hamming;
+      vector<vector<uint8_t>> asymmetricHamming;
+      vector<vector<uint8_t>> edit;
+      vector<vector<uint8_t>> asymmetricEdit;
+      for (vector<uint8_t> const& other: unique) {
+        if (hammingDistance(word, other) <= size_t(distance)) {
+          hamming.push_back(other);
+          if (other >= word) {
+            asymmetricHamming.push_back(other);
+          }
+        }
+        if (editDistance(word, other) <= size_t(distance)) {
+          edit.push_back(other);
+          if (other >= word) {
+            asymmetricEdit.push_back(other);
+          }
+        }
+      }
+
+      REQUIRE(paths(radix.hamming(word, distance)) == hamming);
+      REQUIRE(
+        paths(radix.asymmetricHamming(word, distance)) == asymmetricHamming);
+      REQUIRE(paths(radix.levenshtein(word, distance)) == edit);
+      REQUIRE(
+        paths(radix.asymmetricLevenshtein(word, distance)) == asymmetricEdit);
+    }
+  }
+}
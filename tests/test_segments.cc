@@ -0,0 +1,82 @@
+#include <catch.hpp>
+
+#include "../src/segments.h"
+
+
+TEST_CASE("Test making segments", "[segments]") {
+  SECTION("Without budgets") {
+    Segments segments {makeSegments(4, {2, 3}, "", 2)};
+    REQUIRE(segments.lengths == vector<size_t> {9});
+    REQUIRE(segments.budgets == vector<size_t> {2});
+    REQUIRE(not partitioned(segments));
+    REQUIRE(fuzzyDistance(segments) == 2);
+  }
+
+  SECTION("With a UMI in the header") {
+    Segments segments {makeSegments(4, {2, 3}, "1,0,0", 2)};
+    REQUIRE(segments.lengths == vector<size_t> {4, 2, 3});
+    REQUIRE(segments.budgets == vector<size_t> {1, 0, 0});
+    REQUIRE(partitioned(segments));
+    REQUIRE(fuzzyDistance(segments) == 1);
+    REQUIRE(fuzzySegments(segments) == 1);
+  }
+
+  SECTION("Without a UMI in the header") {
+    Segments segments {makeSegments(0, {2, 3}, "0,2", 2)};
+    REQUIRE(segments.lengths == vector<size_t> {2, 3});
+    REQUIRE(segments.budgets == vector<size_t> {0, 2});
+  }
+
+  SECTION("Wrong number of budgets") {
+    REQUIRE_THROWS(makeSegments(4, {2, 3}, "1,0", 2));
+  }
+}
+
+TEST_CASE("Test making the start of a word exact", "[segments]") {
+  SECTION("Within one segment") {
+    Segments segments {exactPrefix(makeSegments(0, {10}, "", 2), 4)};
+    REQUIRE(segments.lengths == vector<size_t> {4, 6});
+    REQUIRE(segments.budgets == vector<size_t> {0, 2});
+    REQUIRE(fuzzyDistance(segments) == 2);
+  }
+
+  SECTION("Segment boundary") {
+    Segments segments {exactPrefix(makeSegments(4, {2, 3}, "1,1,2", 2), 4)};
+    REQUIRE(segments.lengths == vector<size_t> {4, 2, 3});
+    REQUIRE(segments.budgets == vector<size_t> {0, 1, 2});
+    REQUIRE(fuzzySegments(segments) == 2);
+  }
+
+  SECTION("Multiple segments") {
+    Segments segments {exactPrefix(makeSegments(0, {2, 3}, "1,2", 2), 3)};
+    REQUIRE(segments.lengths == vector<size_t> {2, 1, 2});
+    REQUIRE(segments.budgets == vector<size_t> {0, 0, 2});
+  }
+
+  SECTION("Whole word") {
+    Segments segments {exactPrefix(makeSegments(0, {2, 3}, "", 2), 5)};
+    REQUIRE(segments.lengths == vector<size_t> {5});
+    REQUIRE(segments.budgets == vector<size_t> {0});
+    REQUIRE(fuzzyDistance(segments) == 0);
+  }
+}
+
+TEST_CASE("Test splitting a word", "[segments]") {
+  Segments segments {makeSegments(2, {2, 3}, "1,0,2", 2)};
+  string key;
+  vector<uint8_t> fuzzy;
+
+  splitWord({0, 1, 2, 3, 0, 1, 2}, segments, key, fuzzy);
+  REQUIRE(key == string {2, 3});
+  REQUIRE(fuzzy == vector<uint8_t> {0, 1, 0, 1, 2});
+}
+
+TEST_CASE("Test checking budgets per segment", "[segments]") {
+  // The exact segment is not part of the words that are compared.
+  Segments segments {makeSegments(2, {2, 3}, "1,0,1", 2)};
+
+  REQUIRE(withinBudgets({0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}, segments));
+  REQUIRE(withinBudgets({0, 0, 0, 0, 0}, {1, 0, 0, 0, 1}, segments));
+  REQUIRE(not withinBudgets({0, 0, 0, 0, 0}, {1, 1, 0, 0, 0}, segments));
+  REQUIRE(not withinBudgets({0, 0, 0, 0, 0}, {0, 0, 1, 0, 1}, segments));
+}
@@ -0,0 +1,90 @@
+#include <catch.hpp>
+
+#include <random>
+
+#include "../src/radix.tcc"
+#include "../src/shards.tcc"
+
+using std::mt19937;
+
+
+// Helper function to make random words.
+vector<vector<uint8_t>> randomShardWords(
+    size_t const number, size_t const length, unsigned int const seed) {
+  mt19937 generator(seed);
+  vector<vector<uint8_t>> words;
+  for (size_t i {0}; i < number; i++) {
+    vector<uint8_t> word;
+    for (size_t j {0}; j < length; j++) {
+      word.push_back(generator() % (j < 2 ? 2 : 4));
+    }
+    words.push_back(word);
+  }
+  return words;
+}
+
+// Helper function to collect search results in order.
+vector<vector<uint8_t>> orderedPaths(generator<Result<Leaf>> results) {
+  vector<vector<uint8_t>> found;
+  for (Result<Leaf> const& result: results) {
+    found.push_back(result.path);
+  }
+  return found;
+}
+
+
+TEST_CASE("Test adding and finding words in a sharded trie", "[shards]") {
+  ShardedTrie<RadixTrie<>> trie {2};
+  REQUIRE(trie.shards() == 16);
+
+  trie.add({0, 1, 2, 3});
+  trie.add({0, 1, 2, 3});
+  trie.add({3, 1, 2, 3});
+
+  REQUIRE(trie.shard({0, 1, 2, 3}) == 1);
+  REQUIRE(trie.shard({3, 1, 2, 3}) == 13);
+  REQUIRE(trie.find({0, 1, 2, 3})->leaf->count == 2);
+  REQUIRE(trie.find({3, 1, 2, 3})->leaf->count == 1);
+  REQUIRE(not trie.find({0, 1, 2, 2}));
+  REQUIRE(not trie.find({1, 1, 2, 3}));
+  REQUIRE(trie.store(1));
+  REQUIRE(not trie.store(0));
+}
+
+TEST_CASE("Test searching a sharded trie", "[shards]") {
+  vector<vector<uint8_t>> const words {randomShardWords(300, 10, 3)};
+  RadixTrie<> single;
+  for (vector<uint8_t> const& word: words) {
+    single.add(word);
+  }
+
+  for (size_t const prefix: {0, 1, 3}) {
+    ShardedTrie<RadixTrie<>> sharded {prefix};
+    for (vector<uint8_t> const& word: words) {
+      sharded.add(word);
+    }
+
+    // The results and their order are the same as those of a single trie.
+    vector<vector<uint8_t>> const unique {orderedPaths(single.walk())};
+    REQUIRE(orderedPaths(sharded.walk()) == unique);
+    for (int const distance: {0, 1, 2}) {
+      for (vector<uint8_t> const& word: unique) {
+        REQUIRE(
+          orderedPaths(sharded.hamming(word, distance)) ==
+          orderedPaths(single.hamming(word, distance)));
+        REQUIRE(
+          orderedPaths(sharded.asymmetricHamming(word, distance)) ==
+          orderedPaths(single.asymmetricHamming(word, distance)));
+      }
+    }
+
+    if (prefix) {
+      REQUIRE_THROWS(orderedPaths(sharded.levenshtein(unique.front(), 1)));
+    }
+    else {
+      REQUIRE(
+        orderedPaths(sharded.levenshtein(unique.front(), 1)) ==
+        orderedPaths(single.levenshtein(unique.front(), 1)));
+    }
+  }
+}
@@ -0,0 +1,63 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include "../src/sidecar.h"
+
+using std::filesystem::file_size;
+using std::filesystem::remove;
+using std::filesystem::resize_file;
+using std::filesystem::temp_directory_path;
+using std::ios;
+using std::ofstream;
+
+
+TEST_CASE("Test writing and reading cluster IDs", "[sidecar]") {
+  string const fileName {temp_directory_path() / "humid_cluster_ids.bin"};
+
+  ReadClusters clusters;
+  for (uint32_t i {0}; i < 200000; i++) {
+    clusters.ids.push_back(i % 7 ? i / 3 : 0);
+    clusters.representative.push_back(i % 3 == 1);
+  }
+  writeSidecar(fileName, clusters);
+  REQUIRE(file_size(fileName) == 16 + 4 * clusters.ids.size());
+
+  SidecarReader reader {fileName};
+  REQUIRE(reader.size() == clusters.ids.size());
+
+  // The reads span multiple chunks.
+  ReadClusters found;
+  uint32_t cluster;
+  bool representative;
+  while (reader.read(cluster, representative)) {
+    found.ids.push_back(cluster);
+    found.representative.push_back(representative);
+  }
+  REQUIRE(found.ids == clusters.ids);
+  REQUIRE(found.representative == clusters.representative);
+
+  remove(fileName);
+}
+
+TEST_CASE("Test reading invalid cluster ID files", "[sidecar]") {
+  string const fileName {temp_directory_path() / "humid_invalid.bin"};
+
+  {
+    ofstream output(fileName, ios::out | ios::binary);
+    output << "@read\nACGT\n+\nIIII\n";
+  }
+  REQUIRE_THROWS(SidecarReader(fileName));
+
+  ReadClusters const clusters {{1, 1, 2}, {true, false, true}};
+  writeSidecar(fileName, clusters);
+  resize_file(fileName, 16 + 4 * 2);
+
+  SidecarReader reader {fileName};
+  uint32_t cluster;
+  bool representative;
+  REQUIRE_THROWS(reader.read(cluster, representative));
+
+  remove(fileName);
+}
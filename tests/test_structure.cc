@@ -0,0 +1,141 @@
+#include <catch.hpp>
+
+#include <stdexcept>
+
+#include "../src/fastq.h"
+#include "../src/structure.h"
+
+using std::invalid_argument;
+
+
+TEST_CASE("Test parsing read structures", "[structure]") {
+  REQUIRE(ReadStructure("8M+T").umiLength() == 8);
+  REQUIRE(ReadStructure("+T").umiLength() == 0);
+  REQUIRE(ReadStructure("4M2S4M10T").umiLength() == 8);
+
+  REQUIRE_THROWS_AS(ReadStructure(""), invalid_argument);
+  REQUIRE_THROWS_AS(ReadStructure("8"), invalid_argument);
+  REQUIRE_THROWS_AS(ReadStructure("8X"), invalid_argument);
+  REQUIRE_THROWS_AS(ReadStructure("0M+T"), invalid_argument);
+  REQUIRE_THROWS_AS(ReadStructure("+T8M"), invalid_argument);
+  REQUIRE_THROWS_AS(ReadStructure("4T+M"), invalid_argument);
+
+  REQUIRE(parseStructures("", 2).empty());
+  REQUIRE(parseStructures("8M+T,+T", 2).size() == 2);
+  REQUIRE(umiLength(parseStructures("8M+T,2S4M+T", 2)) == 12);
+  REQUIRE_THROWS_AS(parseStructures("8M+T", 2), invalid_argument);
+}
+
+TEST_CASE("Test selecting UMI and template bases", "[structure]") {
+  ReadStructure const structure {"2M1S2M+T"};
+
+  string umi;
+  structure.appendUMI("AACGGTTTT", umi);
+  REQUIRE(umi == "AAGG");
+
+  // Bases beyond the end of the sequence are left out.
+  structure.appendUMI("CCA", umi);
+  REQUIRE(umi == "AAGGCC");
+
+  string text;
+  structure.appendTemplate("AACGGTTTT", 10, text);
+  REQUIRE(text == "TTTT");
+  structure.appendTemplate("AACGGACGT", 2, text);
+  REQUIRE(text == "TTTTAC");
+  structure.appendTemplate("AACGG", 2, text);
+  REQUIRE(text == "TTTTAC");
+
+  char buffer[8];
+  REQUIRE(structure.copyUMI("AACGGTTTT", 8, buffer) == 4);
+  REQUIRE(string(buffer, 4) == "AAGG");
+  REQUIRE(structure.copyUMI("CCA", 8, buffer) == 2);
+  REQUIRE(string(buffer, 2) == "CC");
+  REQUIRE(structure.copyUMI("AACGGTTTT", 3, buffer) == 3);
+  REQUIRE(string(buffer, 3) == "AAG");
+  REQUIRE(structure.copyTemplate("AACGGTTTT", 8, buffer) == 4);
+  REQUIRE(string(buffer, 4) == "TTTT");
+  REQUIRE(structure.copyTemplate("AACGGACGT", 2, buffer) == 2);
+  REQUIRE(string(buffer, 2) == "AC");
+  REQUIRE(structure.copyTemplate("AACGG", 2, buffer) == 0);
+}
+
+TEST_CASE("Test making words with read structures", "[structure]") {
+  Read read1("@r1 1:N", "AACCGGGGGGGGGGGGGGGG", "+", "");
+  Read read2("@r1 2:N", "TTTTTTTTTTTTTTTTTTTT", "+", "");
+  vector<Read*> reads {&read1, &read2};
+
+  // The same word as for reads with the UMI in the header.
+  Read header1("@r1_AACC 1:N", "GGGGGGGGGGGGGGGG", "+", "");
+  Read header2("@r1_AACC 2:N", "TTTTTTTTTTTTTTTTTTTT", "+", "");
+  vector<Read*> headers {&header1, &header2};
+
+  vector<ReadStructure> const structures {parseStructures("4M+T,+T", 2)};
+  vector<size_t> const ntToTake {ntFromFile(2, 20)};
+  WordMaker const maker {ntToTake, 4, nullptr, 0, structures};
+  REQUIRE(not maker.specialised());
+
+  Word word;
+  maker.make(reads, word);
+  REQUIRE(word.data == makeWord(headers, ntToTake, 4).data);
+  REQUIRE(not word.filtered);
+
+  // A template that is too short is padded.
+  Read short1("@r1 1:N", "AACCGG", "+", "");
+  vector<Read*> shortReads {&short1, &read2};
+  maker.make(shortReads, word);
+  REQUIRE(word.filtered);
+
+  // Blocks give the same words.
+  ReadBlock<Read*> const block {{reads, shortReads}, 2};
+  Word words[2];
+  maker.make(block, words);
+  REQUIRE(words[0].data == makeWord(headers, ntToTake, 4).data);
+  REQUIRE(not words[0].filtered);
+  REQUIRE(words[1].filtered);
+}
+
+TEST_CASE("Test making words from UMIs longer than the word", "[structure]") {
+  Read read1("@r1 1:N", "AAAACCCCGGGGTTTTACGT", "+", "");
+  Read read2("@r1 2:N", "CCCCGGGGTTTTAAAAACGT", "+", "");
+  vector<Read*> reads {&read1, &read2};
+
+  // The UMI is cut to the word length, as `preCompute()` does.
+  vector<ReadStructure> const structures {
+    parseStructures("16M+T,16M+T", 2)};
+  WordMaker const maker {{0, 0}, 24, nullptr, 0, structures};
+
+  Word word;
+  maker.make(reads, word);
+  REQUIRE(word.data == makeWord("AAAACCCCGGGGTTTTCCCCGGGG").data);
+  REQUIRE(not word.filtered);
+
+  ReadBlock<Read*> const block {{reads}, 1};
+  Word words[1];
+  maker.make(block, words);
+  REQUIRE(words[0].data == word.data);
+}
+
+TEST_CASE("Test trimming in-read UMIs", "[structure]") {
+  Read read1("@r1 1:N", "AACCGTGT", "+", "ABCDEFGH");
+  Read read2("@r1 2:N", "TTACGT", "+", "abcdef");
+  vector<Read*> reads {&read1, &read2};
+
+  string text1 {"@r1 1:N\nAACCGTGT\n+\nABCDEFGH\n"};
+  string text2 {"@r1 2:N\nTTACGT\n+\nabcdef"};
+  Record record1;
+  Record record2;
+  parseRecord(text1, record1, true);
+  parseRecord(text2, record2, true);
+  vector<Record> records {record1, record2};
+
+  ReadTrimmer trimmer {parseStructures("4M+T,2M1S+T", 2)};
+  vector<Record> const& trimmed {trimmer.trim(reads)};
+  REQUIRE(trimmed.size() == 2);
+  REQUIRE(trimmed[0].text == "@r1_AACCTT 1:N\nGTGT\n+\nEFGH\n");
+  REQUIRE(trimmed[0].sequence == "GTGT");
+  REQUIRE(trimmed[1].text == "@r1_AACCTT 2:N\nCGT\n+\ndef\n");
+
+  trimmer.trim(records);
+  REQUIRE(trimmed[0].text == "@r1_AACCTT 1:N\nGTGT\n+\nEFGH\n");
+  REQUIRE(trimmed[1].text == "@r1_AACCTT 2:N\nCGT\n+\ndef\n");
+}
@@ -0,0 +1,102 @@
+#include <catch.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include "../src/whitelist.h"
+
+using std::filesystem::remove;
+using std::filesystem::temp_directory_path;
+using std::ofstream;
+
+
+/* Write a whitelist file. */
+string whitelist_(string const content) {
+  string const name {temp_directory_path() / "humid_whitelist.txt"};
+  ofstream output(name);
+  output << content;
+  return name;
+}
+
+/* Correct a word made from nucleotides. */
+Word corrected_(Whitelist const& whitelist, string const nucleotides) {
+  Word word {makeWord(nucleotides)};
+  whitelist.correct(word);
+  return word;
+}
+
+
+TEST_CASE("Test correcting UMIs", "[whitelist]") {
+  string const name {whitelist_("AAAA\nCCCC\r\nAAAT\n\n")};
+  Whitelist const whitelist {name, 1};
+  remove(name);
+
+  REQUIRE(whitelist.length() == 4);
+  // Neighbours of AAAA and AAAT overlap in AAAC and AAAG, and AAAA and AAAT
+  // are themselves neighbours.
+  REQUIRE(whitelist.size() == 3 * 13 - 2 - 2);
+
+  SECTION("Whitelisted") {
+    Word const word {corrected_(whitelist, "CCCCGT")};
+    REQUIRE(not word.filtered);
+    REQUIRE(word.data == makeWord("CCCCGT").data);
+  }
+
+  SECTION("One mismatch") {
+    Word const word {corrected_(whitelist, "CCACGT")};
+    REQUIRE(not word.filtered);
+    REQUIRE(word.data == makeWord("CCCCGT").data);
+  }
+
+  SECTION("Closest UMI") {
+    REQUIRE(corrected_(whitelist, "AAATTT").data == makeWord("AAATTT").data);
+    REQUIRE(corrected_(whitelist, "AATAGG").data == makeWord("AAAAGG").data);
+  }
+
+  SECTION("Ambiguous") {
+    REQUIRE(corrected_(whitelist, "AAACGT").filtered);
+  }
+
+  SECTION("Too many mismatches") {
+    REQUIRE(corrected_(whitelist, "GGCCGT").filtered);
+  }
+
+  SECTION("Only the UMI is corrected") {
+    REQUIRE(corrected_(whitelist, "GAAAGT").data == makeWord("AAAAGT").data);
+    REQUIRE(corrected_(whitelist, "CCCCAAA").data == makeWord("CCCCAAA").data);
+  }
+}
+
+TEST_CASE("Test correcting UMIs with two mismatches", "[whitelist]") {
+  string const name {whitelist_("AAAAAA\nTTTTTT\n")};
+  Whitelist const whitelist {name, 2};
+  remove(name);
+
+  REQUIRE(whitelist.size() == 2 * (1 + 6 * 3 + 15 * 9));
+  REQUIRE(corrected_(whitelist, "AGACAA").data == makeWord("AAAAAA").data);
+  REQUIRE(corrected_(whitelist, "AGACAT").filtered);
+}
+
+TEST_CASE("Test reading invalid whitelists", "[whitelist]") {
+  SECTION("Missing file") {
+    REQUIRE_THROWS(Whitelist(temp_directory_path() / "humid_missing.txt", 1));
+  }
+
+  SECTION("Empty") {
+    string const name {whitelist_("\n")};
+    REQUIRE_THROWS(Whitelist(name, 1));
+    remove(name);
+  }
+
+  SECTION("Invalid UMI") {
+    string const name {whitelist_("AAAA\nACNA\n")};
+    REQUIRE_THROWS(Whitelist(name, 1));
+    remove(name);
+  }
+
+  SECTION("Different lengths") {
+    string const name {whitelist_("AAAA\nACGTA\n")};
+    REQUIRE_THROWS(Whitelist(name, 1));
+    remove(name);
+  }
+}